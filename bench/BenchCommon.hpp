@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Shared plumbing for the benchmark binaries: timing, percentile summaries
+// and the JSON report. Results go to stdout as one JSON document; progress
+// goes to stderr so the two can be separated.
+namespace Bench {
+
+inline uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Cost of one nowNs() pair, reported so per-op percentiles can be read net
+// of it
+inline uint64_t timerOverheadNs() {
+    std::vector<uint64_t> samples(10000);
+    for (auto& sample : samples) {
+        uint64_t start = nowNs();
+        sample = nowNs() - start;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Exact percentiles over a set of per-operation samples (nanoseconds)
+struct Summary {
+    uint64_t ops = 0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0, p90_ns = 0, p99_ns = 0, p999_ns = 0, max_ns = 0;
+};
+
+inline Summary summarize(std::vector<uint64_t>& samples) {
+    Summary s;
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        size_t rank = static_cast<size_t>(q * static_cast<double>(samples.size()));
+        return samples[std::min(rank, samples.size() - 1)];
+    };
+    uint64_t total = 0;
+    for (uint64_t v : samples) total += v;
+    s.ops = samples.size();
+    s.mean_ns = static_cast<double>(total) / static_cast<double>(samples.size());
+    s.p50_ns = at(0.50);
+    s.p90_ns = at(0.90);
+    s.p99_ns = at(0.99);
+    s.p999_ns = at(0.999);
+    s.max_ns = samples.back();
+    return s;
+}
+
+// One JSON object per result: identifying fields first, then the numbers
+class Report {
+public:
+    explicit Report(std::string benchmark) : benchmark_(std::move(benchmark)) {}
+
+    void setMeta(const std::string& key, const std::string& json_value) {
+        meta_.emplace_back(key, json_value);
+    }
+
+    // fields: preformatted JSON values keyed by name ("\"tree\"", "1000");
+    // extra: likewise, written after the numbers and left out of the
+    // progress line (for bulky values)
+    void add(const std::vector<std::pair<std::string, std::string>>& fields, const Summary& s,
+             double ops_per_sec = 0.0, const std::vector<std::pair<std::string, std::string>>& extra = {}) {
+        std::string out = "{";
+        for (const auto& field : fields) {
+            out += "\"" + field.first + "\":" + field.second + ",";
+        }
+        if (ops_per_sec <= 0.0 && s.mean_ns > 0.0) ops_per_sec = 1e9 / s.mean_ns;
+        char numbers[320];
+        std::snprintf(numbers, sizeof(numbers),
+                      "\"ops\":%llu,\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f,\"p50_ns\":%llu,"
+                      "\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu",
+                      static_cast<unsigned long long>(s.ops), s.mean_ns, ops_per_sec,
+                      static_cast<unsigned long long>(s.p50_ns), static_cast<unsigned long long>(s.p90_ns),
+                      static_cast<unsigned long long>(s.p99_ns), static_cast<unsigned long long>(s.p999_ns),
+                      static_cast<unsigned long long>(s.max_ns));
+        out += numbers;
+        for (const auto& field : extra) {
+            out += ",\"" + field.first + "\":" + field.second;
+        }
+        results_.push_back(out + "}");
+        std::fprintf(stderr, "  %-60s %10.1f ns/op  p99 %8llu ns\n", label(fields).c_str(), s.mean_ns,
+                     static_cast<unsigned long long>(s.p99_ns));
+    }
+
+    void print() const {
+        std::printf("{\n  \"benchmark\": \"%s\",\n", benchmark_.c_str());
+        for (const auto& entry : meta_) {
+            std::printf("  \"%s\": %s,\n", entry.first.c_str(), entry.second.c_str());
+        }
+        std::printf("  \"results\": [\n");
+        for (size_t i = 0; i < results_.size(); ++i) {
+            std::printf("    %s%s\n", results_[i].c_str(), i + 1 < results_.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+
+private:
+    static std::string label(const std::vector<std::pair<std::string, std::string>>& fields) {
+        std::string text;
+        for (const auto& field : fields) {
+            std::string value = field.second;
+            value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+            text += (text.empty() ? "" : " ") + field.first + "=" + value;
+        }
+        return text;
+    }
+
+    std::string benchmark_;
+    std::vector<std::pair<std::string, std::string>> meta_;
+    std::vector<std::string> results_;
+};
+
+inline std::string quoted(const std::string& text) { return "\"" + text + "\""; }
+
+// "--name value" lookup with a default; flags without values use hasFlag
+inline long long argValue(int argc, char** argv, const char* name, long long fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return std::atoll(argv[i + 1]);
+    }
+    return fallback;
+}
+
+inline std::string argString(int argc, char** argv, const char* name, const char* fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return fallback;
+}
+
+inline bool hasFlag(int argc, char** argv, const char* name) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace Bench
@@ -0,0 +1,178 @@
+// Multi-threaded submit/cancel scaling of MatchingEngineCore.
+//
+//   build/bench_contention [--max-threads N] [--ops N] [--shards N] [--quick]
+//
+// For each symbol count (1, 10, 100, 500) and producer count (1, 2, 4 ..
+// 64) a fresh engine is driven by that many threads at once, each
+// submitting and cancelling its own orders on uniformly chosen symbols:
+// 50% passive limits, 10% crossing limits, 5% stop orders and 35% cancels
+// of the thread's own resting orders. Every row reports per-op latency,
+// aggregate throughput, speedup over one producer, and a per-lock breakdown
+// from LockStats: acquisitions, contended acquisitions, wait time per op,
+// and wait/hold time as a share of the producers' wall time. The bench core
+// is built with ME_LOCK_STATS, so absolute numbers include the (uncontended:
+// one try_lock plus two clock reads) instrumentation cost.
+
+#include "BenchCommon.hpp"
+#include "core/MatchingEngine.hpp"
+#include <atomic>
+#include <random>
+#include <thread>
+
+using namespace MatchingEngine;
+
+namespace {
+
+constexpr Price MID = 100000;
+
+struct RunResult {
+    uint64_t elapsed_ns = 0;
+    std::vector<uint64_t> samples;
+    std::array<LockSiteStats, LockStats::SITES> locks{};
+};
+
+void produce(MatchingEngineCore& engine, const std::vector<SymbolId>& symbols, size_t ops, uint64_t seed,
+             std::atomic<size_t>& ready, std::atomic<bool>& go, std::vector<uint64_t>& samples) {
+    std::mt19937_64 rng(seed);
+    std::vector<OrderId> resting;
+    resting.reserve(ops);
+    samples.resize(ops);
+    
+    ready.fetch_add(1);
+    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+    
+    for (size_t i = 0; i < ops; ++i) {
+        const SymbolId symbol = symbols[rng() % symbols.size()];
+        const OrderSide side = (rng() & 1) ? OrderSide::BUY : OrderSide::SELL;
+        const Price away = 1 + static_cast<Price>(rng() % 20);
+        const Quantity quantity = 1 + rng() % 10;
+        const unsigned roll = static_cast<unsigned>(rng() % 100);
+        
+        if (roll < 35 && !resting.empty()) {
+            size_t index = rng() % resting.size();
+            OrderId id = resting[index];
+            resting[index] = resting.back();
+            resting.pop_back();
+            uint64_t start = Bench::nowNs();
+            engine.cancelOrder(id);  // May already have filled
+            samples[i] = Bench::nowNs() - start;
+            continue;
+        }
+        
+        OrderPtr order;
+        if (roll >= 95) {
+            order = engine.createOrder(0, symbol, OrderType::STOP_LOSS, side, 0, quantity);
+            order->stop_price = side == OrderSide::BUY ? MID + away : MID - away;
+        } else {
+            // Crossing limits price through the mid, passive ones rest behind it
+            const bool cross = roll >= 85;
+            const Price offset = cross ? -away : away;
+            const Price price = side == OrderSide::BUY ? MID - offset : MID + offset;
+            order = engine.createOrder(0, symbol, OrderType::LIMIT, side, price, quantity);
+        }
+        uint64_t start = Bench::nowNs();
+        OrderId id = engine.submitOrder(order);
+        samples[i] = Bench::nowNs() - start;
+        if (id != 0) resting.push_back(id);  // Status may change under other producers
+    }
+}
+
+RunResult run(size_t symbol_count, size_t threads, size_t ops, size_t shards) {
+    EngineConfig config;
+    config.shard_count = shards;
+    MatchingEngineCore engine(config);
+    std::vector<SymbolId> symbols;
+    for (size_t i = 0; i < symbol_count; ++i) {
+        symbols.push_back(engine.registerSymbol("SYM" + std::to_string(i)));
+    }
+    // Create every book up front so the timed section measures steady state
+    for (SymbolId symbol : symbols) {
+        engine.cancelOrder(engine.submitOrder(
+            engine.createOrder(0, symbol, OrderType::LIMIT, OrderSide::BUY, MID / 2, 1)));
+    }
+    
+    std::vector<std::vector<uint64_t>> samples(threads);
+    std::vector<std::thread> producers;
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    for (size_t t = 0; t < threads; ++t) {
+        producers.emplace_back(produce, std::ref(engine), std::cref(symbols), ops, 1000 + t, std::ref(ready),
+                               std::ref(go), std::ref(samples[t]));
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    
+    LockStats::reset();
+    RunResult result;
+    uint64_t start = Bench::nowNs();
+    go.store(true, std::memory_order_release);
+    for (auto& producer : producers) producer.join();
+    result.elapsed_ns = Bench::nowNs() - start;
+    result.locks = LockStats::snapshot();
+    
+    for (auto& thread_samples : samples) {
+        result.samples.insert(result.samples.end(), thread_samples.begin(), thread_samples.end());
+    }
+    return result;
+}
+
+std::string lockBreakdown(const RunResult& result, size_t threads) {
+    const double ops = static_cast<double>(result.samples.size());
+    const double thread_ns = static_cast<double>(result.elapsed_ns) * static_cast<double>(threads);
+    std::string out = "{";
+    for (size_t i = 0; i < LockStats::SITES; ++i) {
+        const LockSiteStats& site = result.locks[i];
+        char entry[320];
+        std::snprintf(entry, sizeof(entry),
+                      "%s\"%s\":{\"acquisitions\":%llu,\"contended\":%llu,\"wait_ns\":%llu,"
+                      "\"wait_ns_per_op\":%.1f,\"max_wait_ns\":%llu,\"wait_share\":%.4f,\"hold_share\":%.4f}",
+                      i ? "," : "", lockSiteName(static_cast<LockSite>(i)),
+                      static_cast<unsigned long long>(site.acquisitions),
+                      static_cast<unsigned long long>(site.contended),
+                      static_cast<unsigned long long>(site.wait_ns),
+                      ops > 0 ? static_cast<double>(site.wait_ns) / ops : 0.0,
+                      static_cast<unsigned long long>(site.max_wait_ns),
+                      thread_ns > 0 ? static_cast<double>(site.wait_ns) / thread_ns : 0.0,
+                      thread_ns > 0 ? static_cast<double>(site.hold_ns) / thread_ns : 0.0);
+        out += entry;
+    }
+    return out + "}";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = Bench::hasFlag(argc, argv, "--quick");
+    const size_t max_threads = static_cast<size_t>(Bench::argValue(argc, argv, "--max-threads", quick ? 8 : 64));
+    const size_t ops = static_cast<size_t>(Bench::argValue(argc, argv, "--ops", quick ? 2000 : 20000));
+    const size_t shards = static_cast<size_t>(Bench::argValue(argc, argv, "--shards", 0));
+    
+    Bench::Report report("contention");
+    report.setMeta("timer_overhead_ns", std::to_string(Bench::timerOverheadNs()));
+    report.setMeta("ops_per_thread", std::to_string(ops));
+    report.setMeta("shards", std::to_string(shards));
+    report.setMeta("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+    report.setMeta("lock_stats", LockStats::enabled ? "true" : "false");
+    
+    for (size_t symbols : {size_t(1), size_t(10), size_t(100), size_t(500)}) {
+        if (quick && symbols != 1 && symbols != 100) continue;
+        std::fprintf(stderr, "symbols %zu\n", symbols);
+        double single_thread_rate = 0.0;
+        
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            RunResult result = run(symbols, threads, ops, shards);
+            const double rate = static_cast<double>(result.samples.size()) * 1e9 /
+                                static_cast<double>(result.elapsed_ns);
+            if (threads == 1) single_thread_rate = rate;
+            char speedup[32];
+            std::snprintf(speedup, sizeof(speedup), "%.2f", single_thread_rate > 0 ? rate / single_thread_rate : 0.0);
+            
+            std::string locks = lockBreakdown(result, threads);
+            report.add({{"name", Bench::quoted("scaling")}, {"symbols", std::to_string(symbols)},
+                        {"threads", std::to_string(threads)}, {"speedup", speedup}},
+                       Bench::summarize(result.samples), rate, {{"locks", locks}});
+        }
+    }
+    
+    report.print();
+    return 0;
+}
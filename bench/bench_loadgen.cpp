@@ -0,0 +1,216 @@
+// Synthetic order flow against MatchingEngineCore.
+//
+//   build/bench_loadgen [--messages N] [--rate MSGS_PER_SEC] [--symbols N]
+//                       [--add PCT] [--cancel PCT] [--market PCT]
+//                       [--stop-permille N] [--shards N] [--seed N]
+//
+// Messages arrive as a Poisson process at --rate (0 = as fast as the engine
+// accepts them). Each is a passive limit add, a cancel of a random resting
+// order, or a market order, on a uniformly chosen symbol. Limit prices sit a
+// geometrically distributed number of ticks behind a random-walking mid, and
+// a fraction of adds are stop orders on the far side of the mid.
+//
+// Latency is reported two ways: service time (submit call to return) and
+// response time measured from the scheduled arrival, which includes any
+// backlog when the engine falls behind the offered rate.
+
+#include "BenchCommon.hpp"
+#include "core/MatchingEngine.hpp"
+#include <atomic>
+#include <random>
+#include <thread>
+
+using namespace MatchingEngine;
+
+namespace {
+
+constexpr Price START_MID = 100000;
+
+enum Kind { ADD, STOP, CANCEL, MARKET, KIND_COUNT };
+const char* kindName(int kind) {
+    static const char* names[] = {"add", "stop", "cancel", "market"};
+    return names[kind];
+}
+
+struct SymbolState {
+    SymbolId id;
+    Price mid = START_MID;
+    std::vector<OrderId> resting;  // Candidates for cancels; may have filled since
+    uint64_t trades = 0;
+};
+
+struct LoadConfig {
+    size_t messages;
+    double rate;
+    size_t symbols;
+    int add_pct, cancel_pct, market_pct;
+    int stop_permille;
+    size_t shards;
+    uint64_t seed;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadConfig cfg;
+    cfg.messages = static_cast<size_t>(Bench::argValue(argc, argv, "--messages", 1000000));
+    cfg.rate = static_cast<double>(Bench::argValue(argc, argv, "--rate", 0));
+    cfg.symbols = static_cast<size_t>(std::max<long long>(1, Bench::argValue(argc, argv, "--symbols", 8)));
+    cfg.add_pct = static_cast<int>(Bench::argValue(argc, argv, "--add", 55));
+    cfg.cancel_pct = static_cast<int>(Bench::argValue(argc, argv, "--cancel", 40));
+    cfg.market_pct = static_cast<int>(Bench::argValue(argc, argv, "--market", 5));
+    cfg.stop_permille = static_cast<int>(Bench::argValue(argc, argv, "--stop-permille", 20));
+    cfg.shards = static_cast<size_t>(Bench::argValue(argc, argv, "--shards", 0));
+    cfg.seed = static_cast<uint64_t>(Bench::argValue(argc, argv, "--seed", 7));
+    const int mix_total = std::max(1, cfg.add_pct + cfg.cancel_pct + cfg.market_pct);
+    
+    EngineConfig engine_config;
+    engine_config.shard_count = cfg.shards;
+    MatchingEngineCore engine(engine_config);
+    
+    std::vector<SymbolState> symbols(cfg.symbols);
+    for (size_t i = 0; i < cfg.symbols; ++i) {
+        symbols[i].id = engine.registerSymbol("SYM" + std::to_string(i));
+    }
+    // Counted per symbol on the matching thread(s); read after the run
+    std::unique_ptr<std::atomic<uint64_t>[]> trades(new std::atomic<uint64_t>[cfg.symbols]);
+    for (size_t i = 0; i < cfg.symbols; ++i) trades[i].store(0);
+    engine.setTradeCallback([&](const Trade& trade) {
+        trades[trade.symbol_id].fetch_add(1, std::memory_order_relaxed);
+    });
+    
+    std::mt19937_64 rng(cfg.seed);
+    std::uniform_int_distribution<int> percent(0, mix_total - 1);
+    std::uniform_int_distribution<int> permille(0, 999);
+    std::uniform_int_distribution<size_t> pick_symbol(0, cfg.symbols - 1);
+    std::geometric_distribution<int> offset_ticks(0.15);   // Mean ~6 ticks behind the mid
+    std::uniform_int_distribution<Quantity> lots(1, 10);
+    std::bernoulli_distribution coin(0.5);
+    std::exponential_distribution<double> gap(cfg.rate > 0 ? cfg.rate / 1e9 : 1.0);
+    
+    std::vector<uint64_t> service[KIND_COUNT];
+    std::vector<uint64_t> response;
+    for (auto& samples : service) samples.reserve(cfg.messages);
+    response.reserve(cfg.rate > 0 ? cfg.messages : 0);
+    uint64_t rejected = 0, cancel_misses = 0;
+    
+    std::fprintf(stderr, "loadgen: %zu messages, rate %s, %zu symbols, shards %zu\n", cfg.messages,
+                 cfg.rate > 0 ? std::to_string(static_cast<long long>(cfg.rate)).c_str() : "max",
+                 cfg.symbols, cfg.shards);
+    
+    const uint64_t run_start = Bench::nowNs();
+    double scheduled = static_cast<double>(run_start);
+    for (size_t n = 0; n < cfg.messages; ++n) {
+        if (cfg.rate > 0) {
+            scheduled += gap(rng);
+            while (static_cast<double>(Bench::nowNs()) < scheduled) {}  // Open loop: never wait on the engine
+        }
+        
+        SymbolState& sym = symbols[pick_symbol(rng)];
+        if (permille(rng) < 50) sym.mid += coin(rng) ? 1 : -1;
+        OrderSide side = coin(rng) ? OrderSide::BUY : OrderSide::SELL;
+        const Price away = 1 + offset_ticks(rng);
+        
+        int roll = percent(rng);
+        int kind = roll < cfg.add_pct ? ADD : roll < cfg.add_pct + cfg.cancel_pct ? CANCEL : MARKET;
+        if (kind == CANCEL && sym.resting.empty()) kind = ADD;
+        if (kind == ADD && permille(rng) < cfg.stop_permille) kind = STOP;
+        
+        OrderPtr order;
+        OrderId cancel_id = 0;
+        switch (kind) {
+            case ADD: {
+                Price price = side == OrderSide::BUY ? sym.mid - away : sym.mid + away;
+                order = engine.createOrder(0, sym.id, OrderType::LIMIT, side, price, lots(rng));
+                break;
+            }
+            case STOP: {
+                // Sell stops below the mid, buy stops above it
+                order = engine.createOrder(0, sym.id, OrderType::STOP_LOSS, side, 0, lots(rng));
+                order->stop_price = side == OrderSide::BUY ? sym.mid + away : sym.mid - away;
+                break;
+            }
+            case MARKET:
+                order = engine.createOrder(0, sym.id, OrderType::MARKET, side, 0, lots(rng));
+                break;
+            case CANCEL: {
+                size_t index = rng() % sym.resting.size();
+                cancel_id = sym.resting[index];
+                sym.resting[index] = sym.resting.back();
+                sym.resting.pop_back();
+                break;
+            }
+        }
+        
+        uint64_t start = Bench::nowNs();
+        if (kind == CANCEL) {
+            if (!engine.cancelOrder(cancel_id)) cancel_misses++;
+        } else {
+            OrderId id = engine.submitOrder(order);
+            if (id == 0) {
+                rejected++;
+            } else if (kind == ADD && (order->status == OrderStatus::ACTIVE ||
+                                       order->status == OrderStatus::PARTIAL_FILL)) {
+                sym.resting.push_back(id);
+            }
+        }
+        uint64_t end = Bench::nowNs();
+        service[kind].push_back(end - start);
+        if (cfg.rate > 0) response.push_back(end - static_cast<uint64_t>(scheduled));
+    }
+    const uint64_t elapsed = Bench::nowNs() - run_start;
+    
+    Bench::Report report("loadgen");
+    const double throughput = static_cast<double>(cfg.messages) * 1e9 / static_cast<double>(elapsed);
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.0f", throughput);
+    report.setMeta("messages", std::to_string(cfg.messages));
+    report.setMeta("target_rate", std::to_string(static_cast<long long>(cfg.rate)));
+    report.setMeta("sustained_msgs_per_sec", number);
+    report.setMeta("elapsed_ns", std::to_string(elapsed));
+    report.setMeta("symbols", std::to_string(cfg.symbols));
+    report.setMeta("shards", std::to_string(cfg.shards));
+    report.setMeta("mix", "{\"add\":" + std::to_string(cfg.add_pct) + ",\"cancel\":" +
+                          std::to_string(cfg.cancel_pct) + ",\"market\":" + std::to_string(cfg.market_pct) +
+                          ",\"stop_permille\":" + std::to_string(cfg.stop_permille) + "}");
+    report.setMeta("rejected", std::to_string(rejected));
+    report.setMeta("cancel_misses", std::to_string(cancel_misses));
+    report.setMeta("trades", std::to_string(engine.getTotalTradesExecuted()));
+    
+    std::vector<uint64_t> all;
+    for (int kind = 0; kind < KIND_COUNT; ++kind) {
+        all.insert(all.end(), service[kind].begin(), service[kind].end());
+        if (service[kind].empty()) continue;
+        report.add({{"name", Bench::quoted("service")}, {"op", Bench::quoted(kindName(kind))}},
+                   Bench::summarize(service[kind]));
+    }
+    report.add({{"name", Bench::quoted("service")}, {"op", Bench::quoted("all")}}, Bench::summarize(all),
+               throughput);
+    if (!response.empty()) {
+        report.add({{"name", Bench::quoted("response")}, {"op", Bench::quoted("all")}},
+                   Bench::summarize(response), throughput);
+    }
+    
+    // Final book shape per symbol
+    std::string books = "[";
+    for (size_t i = 0; i < cfg.symbols; ++i) {
+        const SymbolState& sym = symbols[i];
+        OrderBook* book = engine.getOrderBook(sym.id);
+        TopOfBook top = engine.getTopOfBook(sym.id);
+        size_t bid_levels = book ? book->getBids(1 << 20).size() : 0;
+        size_t ask_levels = book ? book->getAsks(1 << 20).size() : 0;
+        books += std::string(i ? "," : "") + "{\"symbol\":\"" + engine.getSymbolName(sym.id) + "\"" +
+                 ",\"resting_orders\":" + std::to_string(book ? book->totalOrders() : 0) +
+                 ",\"bid_levels\":" + std::to_string(bid_levels) +
+                 ",\"ask_levels\":" + std::to_string(ask_levels) +
+                 ",\"best_bid\":" + (top.hasBid() ? std::to_string(top.bid_price) : "null") +
+                 ",\"best_ask\":" + (top.hasAsk() ? std::to_string(top.ask_price) : "null") +
+                 ",\"trades\":" + std::to_string(trades[i].load()) + "}";
+    }
+    books += "]";
+    report.setMeta("live_orders", std::to_string(engine.getLiveOrderCount()));
+    report.setMeta("books", books);
+    
+    report.print();
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Microbenchmarks for OrderBook, StopOrderManager and MatchingEngineCore.
+//
+//   build/bench_orderbook [--max-depth N] [--ops N] [--quick]
+//
+// Each case runs against books holding 10 .. 1M resting orders, spread over
+// up to 1000 price levels. Every timed operation is undone (untimed) before
+// the next one, so the book shape stays fixed for the whole case.
+
+#include "BenchCommon.hpp"
+#include "core/MatchingEngine.hpp"
+#include "core/OrderBook.hpp"
+#include "core/StopOrderManager.hpp"
+#include <deque>
+#include <memory>
+#include <random>
+
+using namespace MatchingEngine;
+
+namespace {
+
+constexpr SymbolId SYMBOL = 0;
+constexpr Price MID = 1000000;
+constexpr Quantity LOT = 10;
+constexpr size_t MAX_LEVELS = 1000;
+
+// Bids every other tick below MID, so the odd ticks are empty gaps
+Price levelPrice(size_t level) { return MID - 2 * static_cast<Price>(level + 1); }
+
+// A book of `depth` resting bids, plus the FIFO of each level as the
+// harness knows it
+struct BookFixture {
+    OrderBook book;
+    size_t levels;
+    std::unique_ptr<Order[]> orders;
+    std::vector<std::deque<Order*>> queues;
+    Order spare;
+
+    BookFixture(size_t depth, uint32_t ladder_ticks)
+        : book(SYMBOL, spec(ladder_ticks)), levels(std::min(depth, MAX_LEVELS)),
+          orders(new Order[depth]), queues(levels) {
+        for (size_t i = 0; i < depth; ++i) {
+            size_t level = i % levels;
+            orders[i] = Order(i + 1, SYMBOL, OrderType::LIMIT, OrderSide::BUY, levelPrice(level), LOT);
+            book.addOrder(orders[i]);
+            queues[level].push_back(&orders[i]);
+        }
+        spare = Order(depth + 1, SYMBOL, OrderType::LIMIT, OrderSide::BUY, 0, LOT);
+    }
+
+    static SymbolSpec spec(uint32_t ladder_ticks) {
+        SymbolSpec s;
+        s.ladder_ticks = ladder_ticks;
+        return s;
+    }
+
+    void rest(Order* order, size_t level) {
+        *order = Order(order->order_id, SYMBOL, OrderType::LIMIT, OrderSide::BUY, levelPrice(level), LOT);
+        book.addOrder(*order);
+    }
+
+    Quantity levelQuantity(size_t level) const { return LOT * static_cast<Quantity>(queues[level].size()); }
+};
+
+enum class Position { FRONT, MIDDLE, BACK };
+
+const char* positionName(Position position) {
+    switch (position) {
+        case Position::FRONT: return "front";
+        case Position::MIDDLE: return "middle";
+        default: return "back";
+    }
+}
+
+struct Runner {
+    Bench::Report& report;
+    size_t ops;
+    std::mt19937_64 rng{42};
+
+    std::vector<std::pair<std::string, std::string>> fields(const char* name, const char* book,
+                                                            size_t depth) {
+        return {{"name", Bench::quoted(name)}, {"book", Bench::quoted(book)},
+                {"depth", std::to_string(depth)}};
+    }
+
+    void add(BookFixture& f, const char* book, size_t depth, bool new_level) {
+        std::vector<uint64_t> samples(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            size_t level = rng() % f.levels;
+            Price price = levelPrice(level) - (new_level ? 1 : 0);
+            f.spare = Order(f.spare.order_id, SYMBOL, OrderType::LIMIT, OrderSide::BUY, price, LOT);
+            uint64_t start = Bench::nowNs();
+            f.book.addOrder(f.spare);
+            samples[i] = Bench::nowNs() - start;
+            f.book.cancelOrder(f.spare.order_id);
+        }
+        report.add(fields(new_level ? "add_new_level" : "add", book, depth), Bench::summarize(samples));
+    }
+
+    void cancel(BookFixture& f, const char* book, size_t depth, Position position) {
+        std::vector<uint64_t> samples(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            size_t level = rng() % f.levels;
+            auto& queue = f.queues[level];
+            size_t index = position == Position::FRONT ? 0
+                         : position == Position::MIDDLE ? queue.size() / 2 : queue.size() - 1;
+            Order* order = queue[index];
+            uint64_t start = Bench::nowNs();
+            f.book.cancelOrder(order->order_id);
+            samples[i] = Bench::nowNs() - start;
+            queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(index));
+            f.rest(order, level);
+            queue.push_back(order);
+        }
+        auto row = fields("cancel", book, depth);
+        row.emplace_back("position", Bench::quoted(positionName(position)));
+        report.add(row, Bench::summarize(samples));
+    }
+
+    // A market sell that empties exactly the best `levels` levels
+    void sweep(BookFixture& f, const char* book, size_t depth, size_t levels) {
+        Quantity quantity = 0;
+        size_t fills = 0;
+        for (size_t level = 0; level < levels; ++level) {
+            quantity += f.levelQuantity(level);
+            fills += f.queues[level].size();
+        }
+        size_t iterations = std::min(ops, std::max<size_t>(20, ops / fills));
+        std::vector<uint64_t> samples(iterations);
+        for (size_t i = 0; i < iterations; ++i) {
+            Order taker(0, SYMBOL, OrderType::MARKET, OrderSide::SELL, 0, quantity);
+            uint64_t start = Bench::nowNs();
+            auto trades = f.book.matchOrder(taker);
+            samples[i] = Bench::nowNs() - start;
+            for (size_t level = 0; level < levels; ++level) {
+                for (Order* order : f.queues[level]) f.rest(order, level);
+            }
+        }
+        auto row = fields("sweep", book, depth);
+        row.emplace_back("levels", std::to_string(levels));
+        row.emplace_back("fills_per_op", std::to_string(fills));
+        report.add(row, Bench::summarize(samples));
+    }
+
+    void fokCheck(BookFixture& f, const char* book, size_t depth, size_t levels) {
+        Quantity quantity = 0;
+        for (size_t level = 0; level < levels; ++level) quantity += f.levelQuantity(level);
+        Order fok(0, SYMBOL, OrderType::FOK, OrderSide::SELL, levelPrice(levels - 1), quantity);
+        std::vector<uint64_t> samples(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            uint64_t start = Bench::nowNs();
+            bool fillable = f.book.canFillFOK(fok);
+            samples[i] = Bench::nowNs() - start;
+            if (!fillable) std::abort();
+        }
+        auto row = fields("fok_check", book, depth);
+        row.emplace_back("levels", std::to_string(levels));
+        report.add(row, Bench::summarize(samples));
+    }
+};
+
+// `depth` sell stops on distinct prices; a trade at the highest stop price
+// triggers exactly one of them
+void benchStops(Runner& runner, size_t depth) {
+    const Price base = MID - static_cast<Price>(depth) - 1;
+    StopOrderManager stops;
+    std::unique_ptr<Order[]> orders(new Order[depth]);
+    auto arm = [&](size_t i) {
+        orders[i] = Order(i + 1, SYMBOL, OrderType::STOP_LOSS, OrderSide::SELL, 0, LOT);
+        orders[i].stop_price = base + static_cast<Price>(i);
+        stops.addStopOrder(orders[i]);
+    };
+    for (size_t i = 0; i < depth; ++i) arm(i);
+    
+    const Price top = base + static_cast<Price>(depth) - 1;
+    std::vector<uint64_t> samples(runner.ops);
+    for (size_t i = 0; i < runner.ops; ++i) {
+        uint64_t start = Bench::nowNs();
+        auto triggered = stops.checkTriggers(SYMBOL, top, top);
+        samples[i] = Bench::nowNs() - start;
+        if (triggered.size() != 1) std::abort();
+        arm(depth - 1);
+    }
+    runner.report.add({{"name", Bench::quoted("stop_trigger")}, {"book", Bench::quoted("stops")},
+                       {"depth", std::to_string(depth)}}, Bench::summarize(samples));
+    
+    for (size_t i = 0; i < runner.ops; ++i) {
+        uint64_t start = Bench::nowNs();
+        auto triggered = stops.checkTriggers(SYMBOL, top + 1, top + 1);
+        samples[i] = Bench::nowNs() - start;
+        if (!triggered.empty()) std::abort();
+    }
+    runner.report.add({{"name", Bench::quoted("stop_check_idle")}, {"book", Bench::quoted("stops")},
+                       {"depth", std::to_string(depth)}}, Bench::summarize(samples));
+}
+
+// The same add/cancel through MatchingEngineCore (validation, id index,
+// pooled orders, retirement) on an inline engine
+void benchEngine(Runner& runner, size_t depth) {
+    MatchingEngineCore engine;
+    SymbolId symbol = engine.registerSymbol("BENCH");
+    const size_t levels = std::min(depth, MAX_LEVELS);
+    std::vector<std::deque<OrderId>> queues(levels);
+    auto submit = [&](size_t level) {
+        return engine.submitOrder(engine.createOrder(0, symbol, OrderType::LIMIT, OrderSide::BUY,
+                                                     levelPrice(level), LOT));
+    };
+    for (size_t i = 0; i < depth; ++i) queues[i % levels].push_back(submit(i % levels));
+    
+    std::vector<uint64_t> samples(runner.ops);
+    for (size_t i = 0; i < runner.ops; ++i) {
+        size_t level = runner.rng() % levels;
+        auto order = engine.createOrder(0, symbol, OrderType::LIMIT, OrderSide::BUY, levelPrice(level), LOT);
+        uint64_t start = Bench::nowNs();
+        OrderId id = engine.submitOrder(order);
+        samples[i] = Bench::nowNs() - start;
+        engine.cancelOrder(id);
+    }
+    runner.report.add({{"name", Bench::quoted("engine_submit")}, {"book", Bench::quoted("engine")},
+                       {"depth", std::to_string(depth)}}, Bench::summarize(samples));
+    
+    for (size_t i = 0; i < runner.ops; ++i) {
+        size_t level = runner.rng() % levels;
+        OrderId id = queues[level].front();
+        uint64_t start = Bench::nowNs();
+        engine.cancelOrder(id);
+        samples[i] = Bench::nowNs() - start;
+        queues[level].pop_front();
+        queues[level].push_back(submit(level));
+    }
+    runner.report.add({{"name", Bench::quoted("engine_cancel")}, {"book", Bench::quoted("engine")},
+                       {"depth", std::to_string(depth)}}, Bench::summarize(samples));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = Bench::hasFlag(argc, argv, "--quick");
+    const size_t max_depth = static_cast<size_t>(Bench::argValue(argc, argv, "--max-depth", quick ? 1000 : 1000000));
+    const size_t ops = static_cast<size_t>(Bench::argValue(argc, argv, "--ops", quick ? 2000 : 20000));
+    
+    Bench::Report report("orderbook");
+    report.setMeta("timer_overhead_ns", std::to_string(Bench::timerOverheadNs()));
+    report.setMeta("ops_per_case", std::to_string(ops));
+    Runner runner{report, ops};
+    
+    for (size_t depth : {size_t(10), size_t(1000), size_t(100000), size_t(1000000)}) {
+        if (depth > max_depth) break;
+        std::fprintf(stderr, "depth %zu\n", depth);
+        
+        for (auto [name, ladder_ticks] : {std::make_pair("tree", 0u), std::make_pair("ladder", 16384u)}) {
+            BookFixture fixture(depth, ladder_ticks);
+            runner.add(fixture, name, depth, false);
+            runner.add(fixture, name, depth, true);
+            for (Position position : {Position::FRONT, Position::MIDDLE, Position::BACK}) {
+                runner.cancel(fixture, name, depth, position);
+            }
+            for (size_t levels : {size_t(1), size_t(10), size_t(100)}) {
+                if (levels <= fixture.levels) runner.sweep(fixture, name, depth, levels);
+            }
+            runner.fokCheck(fixture, name, depth, std::min<size_t>(10, fixture.levels));
+        }
+        benchStops(runner, depth);
+        benchEngine(runner, depth);
+    }
+    
+    report.print();
+    return 0;
+}
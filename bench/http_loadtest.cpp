@@ -0,0 +1,358 @@
+// HTTP load generator for RestAPIServer.
+//
+//   build/http_loadtest [--host ADDR] [--port N] [--connections N]
+//                       [--duration-ms N] [--rate REQS_PER_SEC]
+//                       [--post PCT] [--delete PCT] [--get PCT]
+//                       [--symbol NAME] [--no-keep-alive]
+//
+// Each connection runs on its own thread over one persistent (keep-alive)
+// socket, or a fresh socket per request with --no-keep-alive. Requests are a
+// mix of POST /api/v1/orders (limit orders around a fixed mid, a fifth of
+// them crossing), DELETE /api/v1/orders/{id} of an order the connection
+// placed earlier, and GET /api/v1/orderbook/{symbol}.
+//
+// Closed loop (--rate 0, the default): every connection sends its next
+// request as soon as the previous response arrives. Open loop: requests are
+// scheduled as a Poisson process at --rate in total, independent of the
+// server's response times.
+//
+// Latency is reported raw (send to full response) and corrected for
+// coordinated omission. In open loop the corrected latency is measured from
+// each request's scheduled send time. In closed loop, every response slower
+// than the expected interval (the run's median latency) is back-filled with
+// the samples a fixed-rate client would have seen while it was blocked, as
+// HdrHistogram's recordValueWithExpectedInterval does.
+
+#include "BenchCommon.hpp"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <random>
+#include <thread>
+
+namespace {
+
+enum Op { POST, DELETE, GET, OP_COUNT };
+const char* opName(int op) {
+    static const char* names[] = {"post", "delete", "get"};
+    return names[op];
+}
+
+constexpr int MID = 1000;
+
+struct Options {
+    std::string host;
+    int port;
+    size_t connections;
+    uint64_t duration_ns;
+    double rate;
+    int post_pct, delete_pct, get_pct;
+    std::string symbol;
+    bool keep_alive;
+};
+
+// One client socket speaking just enough HTTP/1.1 for this server: a
+// Content-Length body on every response
+class Connection {
+public:
+    Connection(const Options& options, const sockaddr_in& address) : options_(options), address_(address) {}
+    ~Connection() { disconnect(); }
+
+    // Fills status and body; false on a transport error (the socket is
+    // dropped and reopened by the next request)
+    bool request(const char* method, const std::string& path, const std::string& body, int& status,
+                 std::string& response_body) {
+        if (fd_ < 0 && !connect()) return false;
+        
+        std::string message = std::string(method) + " " + path + " HTTP/1.1\r\nHost: " + options_.host + "\r\n";
+        if (!options_.keep_alive) message += "Connection: close\r\n";
+        if (!body.empty()) {
+            message += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        message += "\r\n" + body;
+        
+        if (!sendAll(message) || !readResponse(status, response_body)) {
+            disconnect();
+            return false;
+        }
+        if (!server_keeps_alive_) disconnect();
+        return true;
+    }
+
+    uint64_t connects() const { return connects_; }
+
+private:
+    bool connect() {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) return false;
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address_), sizeof(address_)) < 0) {
+            disconnect();
+            return false;
+        }
+        connects_++;
+        buffer_.clear();
+        return true;
+    }
+
+    void disconnect() {
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+    }
+
+    bool sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool readResponse(int& status, std::string& body) {
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        status = std::atoi(buffer_.c_str() + buffer_.find(' ') + 1);
+        size_t length = 0;
+        size_t field = buffer_.find("Content-Length:");
+        if (field != std::string::npos && field < header_end) {
+            length = std::strtoul(buffer_.c_str() + field + 15, nullptr, 10);
+        }
+        size_t connection = buffer_.find("Connection: close");
+        server_keeps_alive_ = options_.keep_alive && (connection == std::string::npos || connection > header_end);
+        
+        const size_t total = header_end + 4 + length;
+        while (buffer_.size() < total) {
+            if (!fill()) return false;
+        }
+        body.assign(buffer_, header_end + 4, length);
+        buffer_.erase(0, total);
+        return true;
+    }
+
+    bool fill() {
+        char chunk[8192];
+        ssize_t n = read(fd_, chunk, sizeof(chunk));
+        if (n <= 0) return false;
+        buffer_.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    const Options& options_;
+    sockaddr_in address_;
+    int fd_ = -1;
+    bool server_keeps_alive_ = false;
+    std::string buffer_;
+    uint64_t connects_ = 0;
+};
+
+struct WorkerResult {
+    std::vector<uint64_t> latency[OP_COUNT];
+    std::vector<uint64_t> scheduled_latency;  // Open loop only
+    uint64_t transport_errors = 0;
+    uint64_t http_errors = 0;                 // Non-2xx responses
+    uint64_t rejected = 0;                    // 2xx with "success":false
+    uint64_t connects = 0;
+};
+
+void runWorker(const Options& options, const sockaddr_in& address, size_t index, uint64_t start,
+               WorkerResult& result) {
+    Connection connection(options, address);
+    std::mt19937_64 rng(0x5eed + index);
+    const int mix_total = std::max(1, options.post_pct + options.delete_pct + options.get_pct);
+    const double connection_rate = options.rate / static_cast<double>(options.connections);
+    std::exponential_distribution<double> gap(connection_rate > 0 ? connection_rate / 1e9 : 1.0);
+    const uint64_t end = start + options.duration_ns;
+    std::vector<std::string> resting;
+    std::string body, response;
+    double scheduled = static_cast<double>(start);
+    
+    for (;;) {
+        uint64_t now = Bench::nowNs();
+        if (options.rate > 0) {
+            scheduled += gap(rng);
+            if (scheduled >= static_cast<double>(end)) break;
+            while (now < scheduled) {
+                uint64_t wait = static_cast<uint64_t>(scheduled) - now;
+                if (wait > 200000) std::this_thread::sleep_for(std::chrono::nanoseconds(wait - 100000));
+                now = Bench::nowNs();
+            }
+        } else if (now >= end) {
+            break;
+        }
+        
+        int roll = static_cast<int>(rng() % static_cast<uint64_t>(mix_total));
+        int op = roll < options.post_pct ? POST : roll < options.post_pct + options.delete_pct ? DELETE : GET;
+        if (op == DELETE && resting.empty()) op = POST;
+        
+        std::string path;
+        body.clear();
+        if (op == POST) {
+            const bool buy = rng() & 1;
+            const bool cross = rng() % 5 == 0;
+            const int away = 1 + static_cast<int>(rng() % 20);
+            const int price = (buy != cross) ? MID - away : MID + away;
+            path = "/api/v1/orders";
+            body = "{\"symbol\":\"" + options.symbol + "\",\"order_type\":\"limit\",\"side\":\"" +
+                   (buy ? "buy" : "sell") + "\",\"quantity\":" + std::to_string(1 + rng() % 5) +
+                   ",\"price\":" + std::to_string(price) + "}";
+        } else if (op == DELETE) {
+            size_t pick = rng() % resting.size();
+            path = "/api/v1/orders/" + resting[pick];
+            resting[pick] = resting.back();
+            resting.pop_back();
+        } else {
+            path = "/api/v1/orderbook/" + options.symbol;
+        }
+        
+        const uint64_t sent = Bench::nowNs();
+        int status = 0;
+        bool ok = connection.request(op == POST ? "POST" : op == DELETE ? "DELETE" : "GET", path, body, status,
+                                     response);
+        const uint64_t done = Bench::nowNs();
+        if (!ok) {
+            result.transport_errors++;
+            continue;
+        }
+        result.latency[op].push_back(done - sent);
+        if (options.rate > 0) result.scheduled_latency.push_back(done - static_cast<uint64_t>(scheduled));
+        
+        if (status < 200 || status >= 300) {
+            result.http_errors++;
+        } else if (response.find("\"success\":false") != std::string::npos) {
+            result.rejected++;
+        } else if (op == POST && response.find("\"status\":\"ACTIVE\"") != std::string::npos) {
+            size_t id = response.find("\"order_id\":\"");
+            if (id != std::string::npos) {
+                id += 12;
+                resting.push_back(response.substr(id, response.find('"', id) - id));
+            }
+        }
+    }
+    result.connects = connection.connects();
+}
+
+// Closed-loop correction: a request that took `latency` while requests were
+// expected every `interval` hid the ones that would have been sent meanwhile
+void addWithExpectedInterval(std::vector<uint64_t>& out, uint64_t latency, uint64_t interval) {
+    out.push_back(latency);
+    if (interval == 0) return;
+    for (uint64_t missing = latency > interval ? latency - interval : 0; missing >= interval; missing -= interval) {
+        out.push_back(missing);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    options.host = Bench::argString(argc, argv, "--host", "127.0.0.1");
+    options.port = static_cast<int>(Bench::argValue(argc, argv, "--port", 8080));
+    options.connections = static_cast<size_t>(std::max<long long>(1, Bench::argValue(argc, argv, "--connections", 16)));
+    options.duration_ns = static_cast<uint64_t>(Bench::argValue(argc, argv, "--duration-ms", 10000)) * 1000000;
+    options.rate = static_cast<double>(Bench::argValue(argc, argv, "--rate", 0));
+    options.post_pct = static_cast<int>(Bench::argValue(argc, argv, "--post", 60));
+    options.delete_pct = static_cast<int>(Bench::argValue(argc, argv, "--delete", 30));
+    options.get_pct = static_cast<int>(Bench::argValue(argc, argv, "--get", 10));
+    options.symbol = Bench::argString(argc, argv, "--symbol", "BTC-USDT");
+    options.keep_alive = !Bench::hasFlag(argc, argv, "--no-keep-alive");
+    
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(options.host.c_str(), nullptr, &hints, &resolved) != 0 || !resolved) {
+        std::fprintf(stderr, "http_loadtest: cannot resolve %s\n", options.host.c_str());
+        return 1;
+    }
+    sockaddr_in address = *reinterpret_cast<sockaddr_in*>(resolved->ai_addr);
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    freeaddrinfo(resolved);
+    
+    std::fprintf(stderr, "http_loadtest: %s:%d, %zu connections, %s, %s, %llu ms\n", options.host.c_str(),
+                 options.port, options.connections,
+                 options.rate > 0 ? ("open loop " + std::to_string(static_cast<long long>(options.rate)) + " req/s").c_str()
+                                  : "closed loop",
+                 options.keep_alive ? "keep-alive" : "connection per request",
+                 static_cast<unsigned long long>(options.duration_ns / 1000000));
+    
+    std::vector<WorkerResult> results(options.connections);
+    std::vector<std::thread> workers;
+    const uint64_t start = Bench::nowNs() + 10000000;  // Let every thread start first
+    for (size_t i = 0; i < options.connections; ++i) {
+        workers.emplace_back([&, i] {
+            while (Bench::nowNs() < start) std::this_thread::yield();
+            runWorker(options, address, i, start, results[i]);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    const uint64_t elapsed = Bench::nowNs() - start;
+    
+    WorkerResult total;
+    for (const WorkerResult& result : results) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            total.latency[op].insert(total.latency[op].end(), result.latency[op].begin(), result.latency[op].end());
+        }
+        total.scheduled_latency.insert(total.scheduled_latency.end(), result.scheduled_latency.begin(),
+                                       result.scheduled_latency.end());
+        total.transport_errors += result.transport_errors;
+        total.http_errors += result.http_errors;
+        total.rejected += result.rejected;
+        total.connects += result.connects;
+    }
+    
+    std::vector<uint64_t> all;
+    for (auto& samples : total.latency) all.insert(all.end(), samples.begin(), samples.end());
+    if (all.empty()) {
+        std::fprintf(stderr, "http_loadtest: no successful requests (is the server running?)\n");
+        return 1;
+    }
+    const double throughput = static_cast<double>(all.size()) * 1e9 / static_cast<double>(elapsed);
+    
+    Bench::Report report("http_loadtest");
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.0f", throughput);
+    report.setMeta("mode", Bench::quoted(options.rate > 0 ? "open" : "closed"));
+    report.setMeta("target_rate", std::to_string(static_cast<long long>(options.rate)));
+    report.setMeta("connections", std::to_string(options.connections));
+    report.setMeta("keep_alive", options.keep_alive ? "true" : "false");
+    report.setMeta("mix", "{\"post\":" + std::to_string(options.post_pct) + ",\"delete\":" +
+                          std::to_string(options.delete_pct) + ",\"get\":" + std::to_string(options.get_pct) + "}");
+    report.setMeta("elapsed_ns", std::to_string(elapsed));
+    report.setMeta("requests", std::to_string(all.size()));
+    report.setMeta("throughput_rps", number);
+    report.setMeta("transport_errors", std::to_string(total.transport_errors));
+    report.setMeta("http_errors", std::to_string(total.http_errors));
+    report.setMeta("rejected", std::to_string(total.rejected));
+    report.setMeta("tcp_connects", std::to_string(total.connects));
+    
+    for (int op = 0; op < OP_COUNT; ++op) {
+        if (total.latency[op].empty()) continue;
+        report.add({{"name", Bench::quoted("raw")}, {"op", Bench::quoted(opName(op))}},
+                   Bench::summarize(total.latency[op]));
+    }
+    Bench::Summary raw = Bench::summarize(all);
+    report.add({{"name", Bench::quoted("raw")}, {"op", Bench::quoted("all")}}, raw, throughput);
+    
+    std::vector<uint64_t> corrected;
+    if (options.rate > 0) {
+        corrected = std::move(total.scheduled_latency);
+    } else {
+        report.setMeta("expected_interval_ns", std::to_string(raw.p50_ns));
+        corrected.reserve(all.size());
+        for (uint64_t latency : all) addWithExpectedInterval(corrected, latency, raw.p50_ns);
+    }
+    report.add({{"name", Bench::quoted("corrected")}, {"op", Bench::quoted("all")}},
+               Bench::summarize(corrected), throughput);
+    
+    report.print();
+    return 0;
+}
@@ -1,11 +1,37 @@
 #pragma once
 
+#include "core/Types.hpp"
+#include "core/Trade.hpp"
 #include <string>
 #include <vector>
 
 namespace MatchingEngine {
 namespace API {
 
+// Decimal <-> tick/lot conversion (the only place the core's integer
+// prices and quantities meet decimals)
+Price priceToTicks(double price, const SymbolSpec& spec);
+double ticksToPrice(double ticks, const SymbolSpec& spec);
+Quantity quantityToLots(double quantity, const SymbolSpec& spec);
+double lotsToQuantity(Quantity lots, const SymbolSpec& spec);
+double notionalToQuote(double notional, const SymbolSpec& spec);
+bool isOnTick(double price, const SymbolSpec& spec);
+bool isOnLot(double quantity, const SymbolSpec& spec);
+// Finite and representable as Price ticks / Quantity lots; check before
+// converting client input
+bool inTickRange(double price, const SymbolSpec& spec);
+bool inLotRange(double quantity, const SymbolSpec& spec);
+std::string formatPrice(Price ticks, const SymbolSpec& spec);
+std::string formatQuantity(Quantity lots, const SymbolSpec& spec);
+// Epoch nanoseconds as ISO 8601 UTC ("2024-01-01T00:00:00.000000000Z")
+std::string formatTimestamp(Timestamp ts);
+
+// Wire form of the core's numeric ids ("ORD000000000042", "BTC-USDT_0000000007")
+std::string formatOrderId(OrderId id);
+std::string formatTradeId(const Symbol& symbol, TradeId id);
+// Accepts "ORD<digits>" or bare digits; returns 0 if the id is malformed
+OrderId parseOrderId(const std::string& text);
+
 // Request to submit a new order
 struct OrderRequest {
     std::string symbol;
@@ -18,6 +44,8 @@ struct OrderRequest {
     
     std::string toJson() const;
     static OrderRequest fromJson(const std::string& json);
+    // Splits a top-level JSON array of order objects
+    static std::vector<OrderRequest> fromJsonArray(const std::string& json);
 };
 
 // Response for order submission
@@ -48,12 +76,44 @@ struct OrderResponse {
 struct OrderBookSnapshot {
     std::string timestamp;
     std::string symbol;
+    uint64_t sequence = 0;  // Book version the levels were taken at
+    std::vector<std::pair<std::string, std::string>> bids;  // [price, quantity]
+    std::vector<std::pair<std::string, std::string>> asks;  // [price, quantity]
+    
+    std::string toJson() const;
+};
+
+// Incremental L2 update: new aggregate per changed level ("0" = level gone).
+// Apply on top of a snapshot whose sequence is below first_sequence.
+struct OrderBookDelta {
+    std::string symbol;
+    uint64_t first_sequence = 0;
+    uint64_t sequence = 0;
     std::vector<std::pair<std::string, std::string>> bids;  // [price, quantity]
     std::vector<std::pair<std::string, std::string>> asks;  // [price, quantity]
     
     std::string toJson() const;
 };
 
+// Trade execution report (decimal view of a core Trade)
+struct TradeReport {
+    std::string timestamp;
+    std::string symbol;
+    std::string trade_id;
+    double price;
+    double quantity;
+    std::string aggressor_side;
+    std::string maker_order_id;
+    std::string taker_order_id;
+    double maker_fee;
+    double taker_fee;
+    double maker_fee_rate;
+    double taker_fee_rate;
+    
+    static TradeReport fromTrade(const Trade& trade, const Symbol& symbol, const SymbolSpec& spec);
+    std::string toJson() const;
+};
+
 // Error response
 struct ErrorResponse {
     std::string error;
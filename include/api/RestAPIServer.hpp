@@ -32,11 +32,19 @@ private:
     
     void serverLoop();
     void handleClient(int client_socket);
-    std::string handleRequest(const std::string& request);
+    std::string handleRequest(const std::string& request, bool keep_alive);
     std::string handleOrderSubmit(const std::string& body);
+    std::string handleOrderBatchSubmit(const std::string& body);
     std::string handleOrderCancel(const std::string& order_id);
     std::string handleOrderQuery(const std::string& order_id);
     std::string handleOrderBookQuery(const std::string& symbol);
+    std::string handleBBOQuery(const std::string& symbol);
+    std::string handleMetrics();
+    
+    // Shared by single and batch submit: nullptr (with resp filled in) if the
+    // request is rejected before reaching the engine
+    OrderPtr buildOrder(const OrderRequest& req, OrderResponse& resp);
+    OrderResponse makeSubmitResponse(const Order& order, OrderId order_id);
 };
 
 } // namespace API
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Types.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Severity levels. Calls below ME_LOG_LEVEL are removed by the preprocessor,
+// arguments included, so disabled logging costs nothing on the hot path.
+#define ME_LOG_LEVEL_DEBUG 0
+#define ME_LOG_LEVEL_INFO  1
+#define ME_LOG_LEVEL_WARN  2
+#define ME_LOG_LEVEL_ERROR 3
+#define ME_LOG_LEVEL_OFF   4
+
+#ifndef ME_LOG_LEVEL
+#define ME_LOG_LEVEL ME_LOG_LEVEL_INFO
+#endif
+
+namespace MatchingEngine {
+
+enum class LogLevel : uint8_t { DEBUG, INFO, WARN, ERROR };
+
+// Low-latency logger: the calling thread copies a fixed-size binary record
+// (format pointer plus up to six raw arguments) into its own SPSC ring and
+// returns; a background thread formats the records and writes them out.
+//
+// Formats use "{}" placeholders and, like string arguments, must have static
+// storage duration (literals), since only the pointer is recorded. Records
+// from one thread stay in order; different threads are interleaved per drain.
+// A full ring drops the record rather than stall the caller. When a thread
+// exits its ring is retired; the writer drains it one last time and frees it.
+class AsyncLogger {
+public:
+    static constexpr size_t MAX_ARGS = 6;  // Keeps a record at 64 bytes
+
+    struct Record {
+        enum ArgType : uint8_t { INT, UINT, DOUBLE, STRING };
+        union Arg {
+            int64_t i;
+            uint64_t u;
+            double d;
+            const char* s;
+        };
+
+        const char* format;
+        LogLevel level;
+        uint8_t arg_count;
+        ArgType types[MAX_ARGS];
+        Arg args[MAX_ARGS];
+    };
+
+    explicit AsyncLogger(FILE* out = stdout, size_t ring_capacity = 4096);
+    ~AsyncLogger();  // Drains everything still queued
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Process-wide logger behind the ME_LOG_* macros (stdout)
+    static AsyncLogger& instance();
+
+    template <typename... Args>
+    void log(LogLevel level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+        Record record;
+        record.format = format;
+        record.level = level;
+        record.arg_count = 0;
+        (encode(record, args), ...);
+        push(record);
+    }
+
+    // Blocks until everything logged so far has been written
+    void flush();
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    // Rings registered by threads and not yet freed
+    size_t ringCount();
+
+    // Renders one record the way the background thread does
+    static void format(const Record& record, std::string& out);
+
+private:
+    // One producer (the owning thread), one consumer (the writer thread)
+    struct Ring {
+        explicit Ring(size_t capacity);
+        const size_t mask;
+        std::unique_ptr<Record[]> records;
+        alignas(64) std::atomic<uint64_t> tail{0};  // Producer
+        alignas(64) std::atomic<uint64_t> head{0};  // Consumer
+        std::atomic<bool> retired{false};           // Owner thread has exited
+    };
+    // Per-thread owner of the thread's rings (one per logger it used); its
+    // destructor retires them. Rings are shared so that either the thread
+    // or the logger can go first.
+    struct ThreadRings {
+        std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;  // By logger id
+        ~ThreadRings();
+    };
+
+    template <typename T>
+    static void encode(Record& record, T value) {
+        uint8_t i = record.arg_count++;
+        if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value) {
+            record.types[i] = Record::STRING;
+            record.args[i].s = value;
+        } else if constexpr (std::is_floating_point<T>::value) {
+            record.types[i] = Record::DOUBLE;
+            record.args[i].d = value;
+        } else if constexpr (std::is_enum<T>::value) {
+            record.types[i] = Record::INT;
+            record.args[i].i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_signed<T>::value) {
+            static_assert(std::is_integral<T>::value, "unsupported log argument type");
+            record.types[i] = Record::INT;
+            record.args[i].i = value;
+        } else {
+            static_assert(std::is_integral<T>::value, "unsupported log argument type");
+            record.types[i] = Record::UINT;
+            record.args[i].u = value;
+        }
+    }
+
+    void push(const Record& record);
+    Ring* ringForThisThread();
+    std::vector<std::shared_ptr<Ring>> snapshotRings();
+    size_t drain(std::string& buffer);
+    void writerLoop();
+
+    FILE* out_;
+    const size_t ring_capacity_;
+    const uint64_t id_;  // Distinguishes loggers in the per-thread ring cache
+
+    std::mutex rings_mutex_;  // Guards registration and removal
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> running_{true};
+    std::thread writer_;
+};
+
+} // namespace MatchingEngine
+
+#define ME_LOG_AT(level, ...) \
+    ::MatchingEngine::AsyncLogger::instance().log(::MatchingEngine::LogLevel::level, __VA_ARGS__)
+
+#if ME_LOG_LEVEL <= ME_LOG_LEVEL_DEBUG
+#define ME_LOG_DEBUG(...) ME_LOG_AT(DEBUG, __VA_ARGS__)
+#else
+#define ME_LOG_DEBUG(...) ((void)0)
+#endif
+
+#if ME_LOG_LEVEL <= ME_LOG_LEVEL_INFO
+#define ME_LOG_INFO(...) ME_LOG_AT(INFO, __VA_ARGS__)
+#else
+#define ME_LOG_INFO(...) ((void)0)
+#endif
+
+#if ME_LOG_LEVEL <= ME_LOG_LEVEL_WARN
+#define ME_LOG_WARN(...) ME_LOG_AT(WARN, __VA_ARGS__)
+#else
+#define ME_LOG_WARN(...) ((void)0)
+#endif
+
+#if ME_LOG_LEVEL <= ME_LOG_LEVEL_ERROR
+#define ME_LOG_ERROR(...) ME_LOG_AT(ERROR, __VA_ARGS__)
+#else
+#define ME_LOG_ERROR(...) ((void)0)
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Types.hpp"
+#include "SeqLock.hpp"
+#include <atomic>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ME_HAVE_TSC 1
+#endif
+
+namespace MatchingEngine {
+
+enum class ClockSource : uint8_t {
+    SYSTEM,  // std::chrono::system_clock on every read
+    TSC,     // rdtsc scaled by a calibration against system_clock
+    MANUAL   // Only moves when set()/advance() is called (replay, tests)
+};
+
+// Nanoseconds since the Unix epoch, as seen by the engine.
+//
+// The engine reads it once per inbound event and stamps that value on the
+// order and every trade it produces, so a sweep costs one clock read. The
+// TSC source turns a read into rdtsc plus a multiply; it falls back to
+// SYSTEM on CPUs without a TSC. Its calibration sits in a SeqLock, so
+// recalibrate() may run on one thread while others keep reading.
+class EngineClock {
+public:
+    explicit EngineClock(ClockSource source = ClockSource::SYSTEM);
+
+    EngineClock(const EngineClock&) = delete;
+    EngineClock& operator=(const EngineClock&) = delete;
+
+    Timestamp now() const {
+        switch (source_) {
+            case ClockSource::MANUAL:
+                return manual_.load(std::memory_order_acquire);
+#ifdef ME_HAVE_TSC
+            case ClockSource::TSC: {
+                Calibration cal = calibration_.load();
+                uint64_t ticks = __rdtsc() - cal.base_ticks;
+                return cal.base_ns + static_cast<Timestamp>(
+                    (static_cast<unsigned __int128>(ticks) * cal.ns_per_tick_q32) >> 32);
+            }
+#endif
+            default:
+                return systemNow();
+        }
+    }
+
+    ClockSource source() const { return source_; }
+
+    // MANUAL only
+    void set(Timestamp ns) { manual_.store(ns, std::memory_order_release); }
+    void advance(uint64_t ns) { manual_.fetch_add(ns, std::memory_order_acq_rel); }
+
+    // TSC only: refit the tick rate over the span since the last calibration
+    // and rebase on the system clock. Never steps time backwards. Call
+    // periodically (from one thread) to bound drift against wall time.
+    void recalibrate();
+
+    static Timestamp systemNow() {
+        return static_cast<Timestamp>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    struct Calibration {
+        uint64_t base_ticks = 0;
+        Timestamp base_ns = 0;
+        uint64_t ns_per_tick_q32 = 0;  // Nanoseconds per tick, 32.32 fixed point
+    };
+
+    ClockSource source_;
+    std::atomic<Timestamp> manual_;
+    SeqLock<Calibration> calibration_;
+};
+
+} // namespace MatchingEngine
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Types.hpp"
+
 // Fee configuration for maker-taker model
 namespace MatchingEngine {
 
@@ -7,13 +9,15 @@ struct FeeConfig {
     static constexpr double MAKER_FEE_RATE = 0.001;  // 0.1%
     static constexpr double TAKER_FEE_RATE = 0.002;  // 0.2%
     
-    static double calculateMakerFee(double price, double quantity) {
-        return price * quantity * MAKER_FEE_RATE;
+    // Fees are in notional units (ticks * lots); scale by tick_size * lot_size
+    // at the API boundary to get quote currency.
+    static double calculateMakerFee(Price price, Quantity quantity) {
+        return static_cast<double>(price) * static_cast<double>(quantity) * MAKER_FEE_RATE;
     }
     
-    static double calculateTakerFee(double price, double quantity) {
-        return price * quantity * TAKER_FEE_RATE;
+    static double calculateTakerFee(Price price, Quantity quantity) {
+        return static_cast<double>(price) * static_cast<double>(quantity) * TAKER_FEE_RATE;
     }
 };
 
-} 
+}
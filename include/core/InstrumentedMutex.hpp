@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+// Lock wait/hold accounting for the engine's mutexes.
+//
+// Built with -DME_LOCK_STATS, every acquisition reads the clock once (to
+// time the hold) and bumps thread-local counters, and unlock reads it again.
+// A lock that is not free at the first try_lock also reads the clock before
+// blocking, to time the wait. Even an uncontended lock/unlock therefore
+// costs two clock reads, which shows up in benchmark numbers. Without the
+// flag InstrumentedMutex is a plain std::mutex and LockStats reports zeros.
+namespace MatchingEngine {
+
+// One entry per engine mutex (or family of mutexes: every book's lock is
+// reported as BOOK)
+enum class LockSite : uint8_t {
+    ORDERS,         // MatchingEngineCore::orders_mutex_ (live/terminal order index)
+    ORDER_BOOKS,    // MatchingEngineCore::order_books_mutex_ (book creation)
+    BOOK,           // OrderBook::book_mutex_
+    STOP_MANAGER,   // StopOrderManager::mutex_
+    TRIGGER_QUEUE,  // Per-shard triggered-stop queues
+    ORDER_POOL,     // OrderPool free list (every create and release)
+    COUNT
+};
+
+const char* lockSiteName(LockSite site);
+
+struct LockSiteStats {
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;   // Acquisitions that had to wait
+    uint64_t wait_ns = 0;     // Total time spent waiting
+    uint64_t max_wait_ns = 0;
+    uint64_t hold_ns = 0;     // Total time held
+};
+
+class LockStats {
+public:
+    static constexpr size_t SITES = static_cast<size_t>(LockSite::COUNT);
+
+#ifdef ME_LOCK_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    // Totals across every thread that has taken an instrumented lock,
+    // including threads that have since exited
+    static std::array<LockSiteStats, SITES> snapshot();
+    static void reset();
+
+    static uint64_t now();
+    static void acquired(LockSite site, uint64_t wait_ns, bool contended);
+    static void released(LockSite site, uint64_t hold_ns);
+};
+
+template <LockSite Site>
+class InstrumentedMutex {
+public:
+    InstrumentedMutex() = default;
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+#ifdef ME_LOCK_STATS
+    void lock() {
+        if (mutex_.try_lock()) {
+            acquired_at_ = LockStats::now();
+            LockStats::acquired(Site, 0, false);
+            return;
+        }
+        uint64_t start = LockStats::now();
+        mutex_.lock();
+        acquired_at_ = LockStats::now();
+        LockStats::acquired(Site, acquired_at_ - start, true);
+    }
+    bool try_lock() {
+        if (!mutex_.try_lock()) return false;
+        acquired_at_ = LockStats::now();
+        LockStats::acquired(Site, 0, false);
+        return true;
+    }
+    void unlock() {
+        LockStats::released(Site, LockStats::now() - acquired_at_);
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex mutex_;
+    uint64_t acquired_at_ = 0;  // Written and read only by the holder
+#else
+    void lock() { mutex_.lock(); }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+
+private:
+    std::mutex mutex_;
+#endif
+};
+
+} // namespace MatchingEngine
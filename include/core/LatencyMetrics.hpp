@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Types.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace MatchingEngine {
+
+// Points in an order's life that are timed
+enum class LatencyStage : uint8_t {
+    REST_PARSE,      // Request body to engine-ready order
+    VALIDATE,        // Admission: id, validation, live index insert
+    MATCH,           // One order against its book, under the book session
+    STOP_TRIGGER,    // Stop trigger evaluation after a match run
+    TRADE_CALLBACK,  // One trade through the trade callback
+    WS_BROADCAST,    // One WebSocket broadcast
+    COUNT
+};
+
+const char* latencyStageName(LatencyStage stage);
+
+// Log-linear (HDR-style) histogram of nanosecond values: each power of two
+// is split into 32 buckets, so any recorded value is reported within ~3%.
+// Values up to 2^40 ns (~18 minutes) are kept; larger ones are clamped.
+// Writers use relaxed atomic adds and never block; readers merge copies.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 6;
+    static constexpr unsigned MAX_BITS = 40;
+    static constexpr size_t BUCKETS = ((MAX_BITS - SUB_BITS + 1) << (SUB_BITS - 1)) + (1u << (SUB_BITS - 1));
+
+    LatencyHistogram();
+
+    void record(uint64_t ns) {
+        counts_[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (ns > seen && !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+    }
+
+    static size_t bucketFor(uint64_t ns);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+    // Merged, point-in-time view of one or more histograms
+    struct Snapshot {
+        std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS, 0);
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        // Smallest bucket bound covering fraction q of the samples (0 if empty)
+        uint64_t percentile(double q) const;
+    };
+    void mergeInto(Snapshot& out) const;
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Latency histograms keyed by stage, symbol and order type.
+//
+// Each key holds a small array of histograms ("stripes"); every thread is
+// assigned one stripe for life, so concurrent writers rarely share a cache
+// line, and reads merge the stripes. Striping rather than one histogram per
+// thread keeps memory bounded when the REST server spawns a thread per
+// connection. A stripe (~9 KB) is allocated by the first record that lands
+// in it, so a key only costs the stripes its writers actually used. The
+// key -> histogram lookup is cached per thread; only the first record of a
+// key on a thread takes the registry mutex.
+class LatencyMetrics {
+public:
+    static constexpr uint8_t NO_ORDER_TYPE = 0xFF;
+
+    // stripes = 0 picks one per hardware thread (capped at 64)
+    explicit LatencyMetrics(size_t stripes = 0);
+    ~LatencyMetrics();
+
+    LatencyMetrics(const LatencyMetrics&) = delete;
+    LatencyMetrics& operator=(const LatencyMetrics&) = delete;
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Start of a timed section; 0 while disabled, which recordSince ignores
+    uint64_t start() const { return enabled() ? now() : 0; }
+    void recordSince(LatencyStage stage, SymbolId symbol_id, uint8_t order_type, uint64_t start) {
+        if (start != 0) record(stage, symbol_id, order_type, now() - start);
+    }
+    void recordSince(LatencyStage stage, SymbolId symbol_id, OrderType order_type, uint64_t start) {
+        recordSince(stage, symbol_id, static_cast<uint8_t>(order_type), start);
+    }
+    void record(LatencyStage stage, SymbolId symbol_id, uint8_t order_type, uint64_t ns);
+
+    // Monotonic nanoseconds
+    static uint64_t now();
+
+    struct Series {
+        LatencyStage stage;
+        SymbolId symbol_id;   // Config::INVALID_SYMBOL when not per symbol
+        uint8_t order_type;   // NO_ORDER_TYPE when not per order type
+        size_t stripes;       // Stripes allocated for this key
+        LatencyHistogram::Snapshot histogram;
+    };
+    // Every key recorded so far, stripes merged, ordered by stage/symbol/type
+    std::vector<Series> snapshot() const;
+
+private:
+    struct Striped {
+        explicit Striped(size_t count);
+        ~Striped();
+        LatencyHistogram& stripe(size_t index);  // Allocated on first use
+        
+        const size_t count;
+        std::unique_ptr<std::atomic<LatencyHistogram*>[]> stripes;  // nullptr = unused
+    };
+
+    static uint64_t keyFor(LatencyStage stage, SymbolId symbol_id, uint8_t order_type) {
+        return (static_cast<uint64_t>(stage) << 40) | (static_cast<uint64_t>(order_type) << 32) | symbol_id;
+    }
+    Striped& lookup(uint64_t key);
+
+    const size_t stripe_count_;
+    const uint64_t id_;  // Distinguishes instances in the per-thread cache
+    std::atomic<bool> enabled_{true};
+
+    mutable std::mutex registry_mutex_;
+    std::unordered_map<uint64_t, std::unique_ptr<Striped>> registry_;
+};
+
+} // namespace MatchingEngine
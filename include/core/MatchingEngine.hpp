@@ -1,68 +1,278 @@
 #pragma once
 
 #include "Order.hpp"
+#include "OrderPool.hpp"
 #include "Trade.hpp"
 #include "OrderBook.hpp"
 #include "StopOrderManager.hpp"
+#include "SymbolRegistry.hpp"
+#include "MpscQueue.hpp"
+#include "TerminalOrderStore.hpp"
+#include "EngineClock.hpp"
+#include "LatencyMetrics.hpp"
+#include "InstrumentedMutex.hpp"
 #include <unordered_map>
+#include <deque>
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <atomic>
 #include <functional>
 
 // Main matching engine logic
 namespace MatchingEngine {
 
+struct EngineConfig {
+    // 0 = match inline on the calling thread. N > 0 = symbols are partitioned
+    // across N matcher threads (symbol_id % N), each the only writer of its
+    // books and stop orders, fed through a lock-free MPSC ring.
+    // Partial step: a shard thread still takes its books' mutexes (uncontended
+    // by other writers, but shared with readers), the engine-wide orders
+    // mutex, and the order pool's mutex; synchronous submit/cancel park on a
+    // per-call mutex/condvar Completion. Per-shard order indexes and pools
+    // are not done yet.
+    size_t shard_count = 0;
+    size_t queue_capacity = 65536;  // Per-shard ring slots
+    bool pin_threads = true;        // Pin shard i to CPU i (Linux only)
+    // Most triggered stops executed per matching event (0 = unlimited). The
+    // rest stay queued and run after the symbol's next match, or when its
+    // shard goes idle (inline mode: on the next call into the engine).
+    size_t stop_cascade_budget = 1024;
+    // Terminal (filled/cancelled/rejected) orders stay queryable through
+    // getOrder until this many newer ones have retired, or until they are
+    // older than the age limit (0 = no age limit).
+    size_t terminal_retention_count = 1 << 20;
+    uint64_t terminal_retention_age_ns = 0;
+    // Read once per inbound event; TSC is cheapest, MANUAL is for replay
+    ClockSource clock_source = ClockSource::SYSTEM;
+    // Per-stage latency histograms (see LatencyMetrics); off saves two
+    // clock reads per order
+    bool latency_metrics = true;
+};
+
+struct StopCascadeStats {
+    uint64_t triggered = 0;         // Triggered stops executed
+    uint64_t cascades = 0;          // Drains that executed at least one stop
+    uint64_t max_depth = 0;         // Longest trigger chain (1 = fired by a regular order)
+    uint64_t budget_exhausted = 0;  // Drains cut short by stop_cascade_budget
+    uint64_t queued = 0;            // Triggered stops still waiting to run
+};
+
 class MatchingEngineCore {
 public:
-    MatchingEngineCore();
-    
-    std::string submitOrder(OrderPtr order);
-    bool cancelOrder(const OrderId& order_id);
-    OrderPtr getOrder(const OrderId& order_id) const;
-    
-    std::shared_ptr<OrderBook> getOrderBook(const Symbol& symbol) const;
-    std::pair<std::optional<Price>, std::optional<Price>> getBBO(const Symbol& symbol) const;
-    
+    explicit MatchingEngineCore(const EngineConfig& config = EngineConfig{});
+    ~MatchingEngineCore();
+
+    MatchingEngineCore(const MatchingEngineCore&) = delete;
+    MatchingEngineCore& operator=(const MatchingEngineCore&) = delete;
+
+    // Allocate an order from the engine's pool (preferred over make_shared)
+    template <typename... Args>
+    OrderPtr createOrder(Args&&... args) {
+        return order_pool_.create(std::forward<Args>(args)...);
+    }
+
+    // Returns the assigned order id, or 0 if the order was rejected. In
+    // sharded mode submitOrder/cancelOrder block until the owning shard has
+    // processed the request, so the order's state is final on return;
+    // submitOrderAsync only validates and enqueues (results arrive through
+    // the callbacks and getOrder).
+    OrderId submitOrder(OrderPtr order);
+    OrderId submitOrderAsync(OrderPtr order);
+    bool cancelOrder(OrderId order_id);
+
+    // Batches are grouped by symbol: each group is matched under one book
+    // lock, its trades are published together and the book update callback
+    // fires once. Within a symbol, orders keep their batch order; stops
+    // triggered by the batch run after it. Results are in input order
+    // (0 / false for rejected or unknown entries).
+    std::vector<OrderId> submitOrders(const std::vector<OrderPtr>& orders);
+    std::vector<bool> cancelOrders(const std::vector<OrderId>& order_ids);
+    OrderPtr getOrder(OrderId order_id) const;
+
+    // Symbols are interned once at the API edge; the core works on SymbolIds
+    SymbolId registerSymbol(const Symbol& symbol) { return symbols_.intern(symbol); }
+    SymbolId findSymbol(const Symbol& symbol) const { return symbols_.find(symbol); }
+    const Symbol& getSymbolName(SymbolId symbol_id) const { return symbols_.name(symbol_id); }
+
+    // Books live for the engine's lifetime; nullptr until the first order
+    OrderBook* getOrderBook(SymbolId symbol_id) const;
+    std::pair<std::optional<Price>, std::optional<Price>> getBBO(SymbolId symbol_id) const;
+    // Wait-free for readers: served from the book's seqlock, never its mutex
+    TopOfBook getTopOfBook(SymbolId symbol_id) const;
+
+    // Tick/lot grid for a symbol; must be set before the symbol's first order
+    SymbolId setSymbolSpec(const Symbol& symbol, const SymbolSpec& spec);
+    SymbolSpec getSymbolSpec(SymbolId symbol_id) const;
+
+    // Callbacks run on the thread that matched (a shard thread when sharded);
+    // install them before submitting orders
     void setTradeCallback(std::function<void(const Trade&)> callback) {
         trade_callback_ = callback;
     }
-    
-    void setBookUpdateCallback(std::function<void(const Symbol&)> callback) {
+
+    void setBookUpdateCallback(std::function<void(SymbolId)> callback) {
         book_update_callback_ = callback;
     }
     
+    // Per-level changes of one match or cancel run, in book order; fires at
+    // most once per run
+    using LevelUpdateCallback = std::function<void(SymbolId, const std::vector<LevelUpdate>&)>;
+    void setLevelUpdateCallback(LevelUpdateCallback callback) {
+        level_update_callback_ = callback;
+    }
+
     uint64_t getTotalOrdersProcessed() const { return total_orders_processed_; }
     uint64_t getTotalTradesExecuted() const { return total_trades_executed_; }
+    size_t getLiveOrderCount() const;
+    size_t getTerminalOrderCount() const;
+    size_t getShardCount() const { return sharded_ ? shards_.size() : 0; }
+    StopCascadeStats getStopCascadeStats() const;
+    
+    EngineClock& clock() { return clock_; }
+    const EngineClock& clock() const { return clock_; }
+    // Shared with the API layer, which records its own stages here
+    LatencyMetrics& latencyMetrics() { return latency_; }
+    const LatencyMetrics& latencyMetrics() const { return latency_; }
 
 private:
-    std::unordered_map<Symbol, std::shared_ptr<OrderBook>> order_books_;
-    mutable std::mutex order_books_mutex_;
-    
-    StopOrderManager stop_order_manager_;
-    
-    std::unordered_map<OrderId, OrderPtr> all_orders_;
-    mutable std::mutex orders_mutex_;
-    
+    using OrdersMutex = InstrumentedMutex<LockSite::ORDERS>;
+    using OrderBooksMutex = InstrumentedMutex<LockSite::ORDER_BOOKS>;
+    using TriggerMutex = InstrumentedMutex<LockSite::TRIGGER_QUEUE>;
+
+    // Caller-side wait for a request handed to a shard. One mutex/condvar
+    // handshake per synchronous call; only submitOrderAsync avoids it.
+    struct Completion {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        bool result = false;
+
+        void signal(bool value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result = value;
+            done = true;
+            cv.notify_one();
+        }
+
+        bool wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return done; });
+            return result;
+        }
+    };
+
+    struct Command {
+        enum class Kind : uint8_t { SUBMIT, CANCEL, SUBMIT_BATCH, CANCEL_BATCH };
+        Kind kind = Kind::SUBMIT;
+        OrderPtr order;
+        Completion* completion = nullptr;
+        std::vector<OrderPtr> batch;
+        std::vector<uint8_t>* results = nullptr;  // CANCEL_BATCH, aligned with batch
+
+        Command() = default;
+        Command(Kind k, OrderPtr o, Completion* c)
+            : kind(k), order(std::move(o)), completion(c) {}
+    };
+
+    // Triggered stops of one symbol, run FIFO after the match that fired
+    // them instead of recursing from inside it. Entries carry their cascade
+    // depth.
+    struct TriggerQueue {
+        std::deque<std::pair<OrderPtr, uint32_t>> pending;
+        bool draining = false;
+    };
+
+    // Everything a shard thread owns. In inline mode there is a single shard
+    // with no thread and an unused queue.
+    struct Shard {
+        StopOrderManager stops;
+        MpscQueue<Command> queue;
+        std::thread thread;
+        std::atomic<bool> running{false};
+        
+        // Only contended in inline mode, where callers match concurrently
+        TriggerMutex trigger_mutex;
+        std::unordered_map<SymbolId, TriggerQueue> triggers;
+        std::atomic<size_t> queued_triggers{0};
+
+        explicit Shard(size_t queue_capacity) : queue(queue_capacity) {}
+    };
+
+    EngineConfig config_;
+    EngineClock clock_;
+    LatencyMetrics latency_;
+    bool sharded_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    SymbolRegistry symbols_;
+
+    // Dense SymbolId-indexed table; slots are published once and never reset,
+    // so lookups are a single acquire load. The mutex only guards creation.
+    std::unique_ptr<std::atomic<OrderBook*>[]> books_;
+    std::vector<std::unique_ptr<OrderBook>> book_storage_;
+    OrderBooksMutex order_books_mutex_;
+
+    OrderPool order_pool_;
+
+    // Live orders (resting or pending stop) own a reference to their pooled
+    // slot; once an order is done it retires into terminal_orders_ as a
+    // compact record and the slot is recycled as soon as outside references
+    // drop. The terminal store is bounded and evicts oldest-first.
+    std::unordered_map<OrderId, OrderPtr> live_orders_;
+    TerminalOrderStore terminal_orders_;
+    mutable OrdersMutex orders_mutex_;
+
     std::function<void(const Trade&)> trade_callback_;
-    std::function<void(const Symbol&)> book_update_callback_;
-    
+    std::function<void(SymbolId)> book_update_callback_;
+    LevelUpdateCallback level_update_callback_;
+
     std::atomic<uint64_t> total_orders_processed_;
     std::atomic<uint64_t> total_trades_executed_;
     std::atomic<uint64_t> order_id_counter_;
     
-    bool validateOrder(const OrderPtr& order, std::string& error) const;
-    void processOrder(OrderPtr order);
-    std::shared_ptr<OrderBook> getOrCreateOrderBook(const Symbol& symbol);
-    std::string generateOrderId();
-    
-    void processMarketOrder(OrderPtr order, std::shared_ptr<OrderBook> book);
-    void processLimitOrder(OrderPtr order, std::shared_ptr<OrderBook> book);
-    void processIOCOrder(OrderPtr order, std::shared_ptr<OrderBook> book);
-    void processFOKOrder(OrderPtr order, std::shared_ptr<OrderBook> book);
-    void processStopOrder(OrderPtr order);
-    void checkAndTriggerStopOrders(const Symbol& symbol, Price last_trade_price);
+    std::atomic<uint64_t> stop_triggers_executed_{0};
+    std::atomic<uint64_t> stop_cascades_{0};
+    std::atomic<uint64_t> stop_cascade_max_depth_{0};
+    std::atomic<uint64_t> stop_budget_exhausted_{0};
+
+    bool validateOrder(const Order& order, std::string& error) const;
+    bool admitOrder(const OrderPtr& order, Timestamp now);
+    void executeOrder(Order& order);
+    void executeOrders(std::vector<Order*>& orders);
+    bool executeCancel(Order& order);
+    void executeCancels(const std::vector<Order*>& orders, uint8_t* results);
+    void cancelRun(SymbolId symbol_id, const std::pair<Order*, size_t>* entries, size_t count,
+                   uint8_t* results);
+    void processOrder(Order& order);
+    void processOrders(SymbolId symbol_id, Order* const* orders, size_t count);
+    void matchRun(SymbolId symbol_id, Order* const* orders, size_t count);
+    void publishTrades(const std::vector<Trade>& trades);
+    void publishLevelUpdates(SymbolId symbol_id, const std::vector<LevelUpdate>& updates);
+    OrderBook& getOrCreateOrderBook(SymbolId symbol_id);
+    OrderId generateOrderId();
+
+    void processMarketOrder(Order& order, OrderBook::Session& book, std::vector<Trade>& trades);
+    void processLimitOrder(Order& order, OrderBook::Session& book, std::vector<Trade>& trades);
+    void processIOCOrder(Order& order, OrderBook::Session& book, std::vector<Trade>& trades);
+    void processFOKOrder(Order& order, OrderBook::Session& book, std::vector<Trade>& trades);
+    void processStopOrder(Order& order);
+    void checkAndTriggerStopOrders(SymbolId symbol_id, Price low, Price high, Timestamp event_time);
+    void drainTriggers(SymbolId symbol_id);
+    void drainQueuedTriggers(Shard& shard, SymbolId skip = Config::INVALID_SYMBOL);
+    void drainInline(SymbolId skip);
+    bool cancelPendingStop(Shard& shard, SymbolId symbol_id, Order& order);
+
+    size_t shardIndex(SymbolId symbol_id) const { return symbol_id % shards_.size(); }
+    Shard& shardFor(SymbolId symbol_id) { return *shards_[shardIndex(symbol_id)]; }
+    void dispatch(Shard& shard, Command&& command);
+    void runShard(size_t index);
+
+    bool isDone(const Order& order) const;
+    void retireOrder(const Order& order);
+    void retireFilledMakers(const std::vector<Trade>& trades);
 };
 
-} 
+}
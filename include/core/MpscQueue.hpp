@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace MatchingEngine {
+
+// Bounded lock-free multi-producer / single-consumer ring.
+//
+// Each cell carries a sequence number: producers claim a position with a CAS
+// on the tail and publish the cell by bumping its sequence; the single
+// consumer owns the head outright. tryPush fails when the ring is full, so
+// the caller decides how to back off.
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity)
+        : mask_(roundUp(capacity) - 1), cells_(new Cell[mask_ + 1]), tail_(0), head_(0) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    bool tryPush(T&& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T& out) {
+        Cell& cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) return false;
+        out = std::move(cell.value);
+        cell.value = T();
+        cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        head_++;
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) size_t head_;
+};
+
+} // namespace MatchingEngine
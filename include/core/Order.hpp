@@ -2,58 +2,66 @@
 
 #include "Types.hpp"
 #include <memory>
-#include <chrono>
 
 // Minimal: Trading order representation
 namespace MatchingEngine {
 
+class PriceLevel;
+
 class Order {
 public:
     OrderId order_id;
-    OrderId client_order_id;
-    Symbol symbol;
+    std::string client_order_id;
+    SymbolId symbol_id;
     
     OrderType type;
     OrderSide side;
-    Price price;              // 0 for market orders
-    Quantity quantity;
+    Price price;              // Ticks, 0 for market orders
+    Quantity quantity;        // Lots
     Quantity filled_quantity;
-    Price average_fill_price;
+    double average_fill_price; // Ticks (fractional across levels)
     Price stop_price;         // Trigger price
     
     OrderStatus status;
-    Timestamp timestamp;
+    Timestamp timestamp;      // Engine clock at admission (0 until submitted)
     uint64_t sequence;
     
+    // Intrusive FIFO linkage, valid while resting on a PriceLevel
+    Order* prev_in_level = nullptr;
+    Order* next_in_level = nullptr;
+    PriceLevel* level = nullptr;
+    
     Order() = default;
     
-    Order(const OrderId& id, const Symbol& sym, OrderType t, OrderSide s, Price p, Quantity q)
-        : order_id(id), symbol(sym), type(t), side(s), price(p), quantity(q),
-          filled_quantity(0.0), average_fill_price(0.0), stop_price(0.0), status(OrderStatus::PENDING),
-          timestamp(getCurrentTimestamp()), sequence(0) {}
+    Order(OrderId id, SymbolId sym, OrderType t, OrderSide s, Price p, Quantity q)
+        : order_id(id), symbol_id(sym), type(t), side(s), price(p), quantity(q),
+          filled_quantity(0), average_fill_price(0.0), stop_price(0), status(OrderStatus::PENDING),
+          timestamp(0), sequence(0) {}
     
     Quantity remainingQuantity() const {
         return quantity - filled_quantity;
     }
     
     bool isFullyFilled() const {
-        return (quantity - filled_quantity) < Config::EPSILON;
+        return filled_quantity >= quantity;
     }
     
     bool canMatchAtPrice(Price match_price) const {
         if (type == OrderType::MARKET) return true;
         
         if (side == OrderSide::BUY) {
-            return price >= match_price - Config::EPSILON;
+            return price >= match_price;
         } else {
-            return price <= match_price + Config::EPSILON;
+            return price <= match_price;
         }
     }
     
     void fill(Quantity qty, Price fill_price) {
-        double total_filled = filled_quantity + qty;
+        Quantity total_filled = filled_quantity + qty;
         if (total_filled > 0) {
-            average_fill_price = ((filled_quantity * average_fill_price) + (qty * fill_price)) / total_filled;
+            average_fill_price = (static_cast<double>(filled_quantity) * average_fill_price +
+                                  static_cast<double>(qty) * static_cast<double>(fill_price)) /
+                                 static_cast<double>(total_filled);
         }
         
         filled_quantity += qty;
@@ -75,27 +83,20 @@ public:
         
         if (side == OrderSide::BUY) {
             if (type == OrderType::TAKE_PROFIT) {
-                return current_price <= stop_price + Config::EPSILON;
+                return current_price <= stop_price;
             } else {
-                return current_price >= stop_price - Config::EPSILON;
+                return current_price >= stop_price;
             }
         } else {
             if (type == OrderType::TAKE_PROFIT) {
-                return current_price >= stop_price - Config::EPSILON;
+                return current_price >= stop_price;
             } else {
-                return current_price <= stop_price + Config::EPSILON;
+                return current_price <= stop_price;
             }
         }
     }
     
     std::string toString() const;
-
-private:
-    static Timestamp getCurrentTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(
-            now.time_since_epoch()).count();
-    }
 };
 
 using OrderPtr = std::shared_ptr<Order>;
@@ -5,7 +5,9 @@
 #include "Order.hpp"
 #include "Trade.hpp"
 #include "PriceLevel.hpp"
-#include <map>
+#include "PriceLadder.hpp"
+#include "SeqLock.hpp"
+#include "InstrumentedMutex.hpp"
 #include <unordered_map>
 #include <vector>
 #include <optional>
@@ -15,52 +17,181 @@
 
 namespace MatchingEngine {
 
+// Top of book as last published by the matcher. Quantity 0 = empty side.
+struct TopOfBook {
+    Price bid_price = 0;
+    Quantity bid_quantity = 0;
+    Price ask_price = 0;
+    Quantity ask_quantity = 0;
+    uint64_t sequence = 0;  // Book version; bumps on every mutation
+    
+    bool hasBid() const { return bid_quantity > 0; }
+    bool hasAsk() const { return ask_quantity > 0; }
+};
+
+// Top-N L2 image of both sides, best first, as of book version `sequence`
+struct DepthImage {
+    struct Level {
+        Price price = 0;
+        Quantity quantity = 0;
+    };
+    
+    uint64_t sequence = 0;
+    uint32_t bid_count = 0;
+    uint32_t ask_count = 0;
+    Level bids[Config::DEPTH_LEVELS];
+    Level asks[Config::DEPTH_LEVELS];
+};
+
+// One price level's new aggregate after a book change (quantity 0 = level
+// removed). sequence is the book version the change becomes visible at, so
+// a client holding a DepthImage applies the updates with a higher sequence.
+struct LevelUpdate {
+    OrderSide side;
+    Price price;
+    Quantity quantity;
+    uint64_t sequence;
+};
+
 class OrderBook {
+    using Mutex = InstrumentedMutex<LockSite::BOOK>;
+
 public:
-    explicit OrderBook(const Symbol& symbol);
+    explicit OrderBook(SymbolId symbol_id, const SymbolSpec& spec = SymbolSpec{});
     
-    void addOrder(OrderPtr order);
-    bool cancelOrder(const OrderId& order_id);
-    std::vector<Trade> matchOrder(OrderPtr order);
-    bool canFillFOK(const OrderPtr& order) const;
+    // Orders are referenced, not owned: the caller keeps each resting order
+    // alive until it is filled or cancelled.
+    void addOrder(Order& order);
+    bool cancelOrder(OrderId order_id);
+    std::vector<Trade> matchOrder(Order& order);
+    // Limit order flow: match, then rest any remainder, in one critical section
+    std::vector<Trade> matchAndRest(Order& order);
+    bool canFillFOK(const Order& order) const;
+    // Fill-or-kill in one critical section: fills the whole order and returns
+    // true, or touches nothing and returns false
+    bool fillOrKill(Order& order, std::vector<Trade>& trades);
     
+    // Holds the book lock across a run of operations (batch processing);
+    // trades from every operation are appended to the caller's buffer. Each
+    // operation publishes the book once, as one new version.
+    class Session {
+    public:
+        explicit Session(OrderBook& book) : book_(book), lock_(book.book_mutex_) {}
+        
+        void addOrder(Order& order) {
+            book_.restOrder(order);
+            book_.updateBBO();
+        }
+        bool cancelOrder(OrderId order_id) {
+            bool removed = book_.removeOrder(order_id);
+            book_.updateBBO();
+            return removed;
+        }
+        void matchOrder(Order& order, std::vector<Trade>& trades) {
+            book_.matchInto(order, trades);
+            book_.updateBBO();
+        }
+        void matchAndRest(Order& order, std::vector<Trade>& trades) {
+            book_.matchInto(order, trades);
+            if (!order.isFullyFilled()) book_.restOrder(order);
+            book_.updateBBO();
+        }
+        bool canFillFOK(const Order& order) const { return book_.fillableQuantityReached(order); }
+        bool fillOrKill(Order& order, std::vector<Trade>& trades) {
+            bool filled = book_.fillOrKillLocked(order, trades);
+            book_.updateBBO();
+            return filled;
+        }
+        // Move the level updates recorded so far into out (appends)
+        void takeLevelUpdates(std::vector<LevelUpdate>& out) {
+            out.insert(out.end(), book_.level_updates_.begin(), book_.level_updates_.end());
+            book_.level_updates_.clear();
+        }
+        
+    private:
+        OrderBook& book_;
+        std::lock_guard<Mutex> lock_;
+    };
+    
+    // Lock-free reads of the published top of book; safe from any thread
+    TopOfBook getTopOfBook() const { return top_.load(); }
     std::pair<std::optional<Price>, std::optional<Price>> getBBO() const;
+    Price getSpread() const;
     void updateBBO();
     
+    // Consistent top-N depth, copied out of the published image without
+    // taking the book lock or allocating
+    DepthImage getDepth() const;
+    
+    // Off by default; once on, every level change is queued for
+    // Session::takeLevelUpdates, so only enable it if someone drains them
+    void setRecordLevelUpdates(bool enabled) { record_level_updates_ = enabled; }
+    
+    // Up to Config::DEPTH_LEVELS these are served from the depth image; deeper
+    // requests walk the book under its lock
     std::vector<std::pair<Price, Quantity>> getBids(int depth = 10) const;
     std::vector<std::pair<Price, Quantity>> getAsks(int depth = 10) const;
     
-    OrderPtr getOrder(const OrderId& order_id) const;
-    const Symbol& getSymbol() const { return symbol_; }
+    Order* getOrder(OrderId order_id) const;
+    SymbolId getSymbolId() const { return symbol_id_; }
+    const SymbolSpec& getSpec() const { return spec_; }
     size_t totalOrders() const;
-    double getSpread() const;
+    bool checkConsistency() const;  // Debug: level aggregates match queues
 
 private:
-    Symbol symbol_;
+    SymbolId symbol_id_;
+    SymbolSpec spec_;
+    
+    mutable Mutex book_mutex_;
+    
+    PriceLadder<OrderSide::BUY> bids_;   // Best (highest) first
+    PriceLadder<OrderSide::SELL> asks_;  // Best (lowest) first
     
-    mutable std::mutex book_mutex_;
+    std::unordered_map<OrderId, Order*> order_map_;
     
-    std::map<Price, PriceLevel, std::greater<Price>> bids_;
-    std::map<Price, PriceLevel, std::less<Price>> asks_;
+    // Written by updateBBO after every mutation (under book_mutex_)
+    SeqLock<TopOfBook> top_;
+    uint64_t book_version_ = 0;
+    bool changed_ = false;  // A level changed since the last publish
     
-    std::unordered_map<OrderId, OrderPtr> order_map_;
+    // The matcher edits depth_working_ in place as levels change and, on
+    // every new book version, publishes it into the back buffer and flips
+    // depth_front_.
+    // Each buffer is a seqlock, so a reader that races two flips retries
+    // instead of seeing a torn image.
+    DepthImage depth_working_;
+    bool rebuild_bids_ = false;
+    bool rebuild_asks_ = false;
+    SeqLock<DepthImage> depth_buffers_[2];
+    std::atomic<uint32_t> depth_front_{0};
     
-    std::optional<Price> best_bid_;
-    std::optional<Price> best_ask_;
+    bool record_level_updates_ = false;
+    std::vector<LevelUpdate> level_updates_;
     
     std::atomic<uint64_t> sequence_counter_;
     std::atomic<uint64_t> trade_id_counter_;
     
-    // Helper methods
-    void matchAgainstBook(OrderPtr order,
-                         std::map<Price, PriceLevel, std::greater<Price>>& book,
-                         std::vector<Trade>& trades);
-    void matchAgainstBook(OrderPtr order,
-                         std::map<Price, PriceLevel, std::less<Price>>& book,
-                         std::vector<Trade>& trades);
-    void matchAtPriceLevel(OrderPtr taker, PriceLevel& level, std::vector<Trade>& trades);
-    Trade createTrade(OrderPtr taker, OrderPtr maker, Price price, Quantity quantity);
-    std::string generateTradeId();
+    // Helper methods (caller holds book_mutex_ and publishes with updateBBO)
+    void restOrder(Order& order);
+    bool removeOrder(OrderId order_id);
+    void matchInto(Order& order, std::vector<Trade>& trades);
+    template <typename Ladder>
+    void matchAgainstBook(Order& order, Ladder& book, std::vector<Trade>& trades);
+    template <typename Ladder>
+    void collectDepth(const Ladder& book, int depth,
+                      std::vector<std::pair<Price, Quantity>>& out) const;
+    void noteLevelChange(OrderSide side, Price price, Quantity quantity, bool created);
+    template <typename Ladder>
+    void rebuildDepth(const Ladder& book, DepthImage::Level* levels, uint32_t& count);
+    void publishDepth();
+    std::vector<std::pair<Price, Quantity>> depthSide(OrderSide side, int depth) const;
+    template <typename Ladder>
+    bool canFillFrom(const Ladder& book, const Order& order) const;
+    bool fillableQuantityReached(const Order& order) const;
+    bool fillOrKillLocked(Order& order, std::vector<Trade>& trades);
+    void matchAtPriceLevel(Order& taker, PriceLevel& level, std::vector<Trade>& trades);
+    Trade createTrade(const Order& taker, const Order& maker, Price price, Quantity quantity);
+    TradeId generateTradeId();
 };
 
 } 
\ No newline at end of file
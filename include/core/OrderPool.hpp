@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Order.hpp"
+#include "InstrumentedMutex.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <new>
+
+namespace MatchingEngine {
+
+// Slab allocator for orders.
+//
+// Orders are carved from fixed-size, cache-line aligned slabs and recycled
+// through a free list, so steady-state order creation never reaches malloc.
+// They are still handed out as OrderPtr (allocate_shared places the control
+// block in the same block), which keeps the public API unchanged; inside the
+// engine and books orders travel as plain Order& / Order* handles, which are
+// stable for the order's lifetime. A block returns to the pool when the last
+// OrderPtr is dropped - the engine drops its own when the order retires.
+class OrderPool {
+public:
+    static constexpr size_t BLOCK_SIZE = (sizeof(Order) + 64 + 63) & ~size_t(63);
+    static constexpr size_t BLOCKS_PER_SLAB = 1024;
+
+    explicit OrderPool(size_t initial_slabs = 1) : storage_(std::make_shared<Storage>()) {
+        std::lock_guard<Mutex> lock(storage_->mutex);
+        for (size_t i = 0; i < initial_slabs; ++i) {
+            storage_->grow();
+        }
+    }
+
+    template <typename... Args>
+    OrderPtr create(Args&&... args) {
+        return std::allocate_shared<Order>(Allocator<Order>(storage_), std::forward<Args>(args)...);
+    }
+
+    size_t capacity() const {
+        std::lock_guard<Mutex> lock(storage_->mutex);
+        return storage_->slabs.size() * BLOCKS_PER_SLAB;
+    }
+
+    size_t available() const {
+        std::lock_guard<Mutex> lock(storage_->mutex);
+        return storage_->free_blocks.size();
+    }
+
+private:
+    using Mutex = InstrumentedMutex<LockSite::ORDER_POOL>;
+
+    struct alignas(64) Block {
+        unsigned char bytes[BLOCK_SIZE];
+    };
+
+    struct Storage {
+        mutable Mutex mutex;
+        std::vector<std::unique_ptr<Block[]>> slabs;
+        std::vector<void*> free_blocks;
+
+        void grow() {
+            slabs.emplace_back(new Block[BLOCKS_PER_SLAB]);
+            free_blocks.reserve(slabs.size() * BLOCKS_PER_SLAB);
+            Block* slab = slabs.back().get();
+            for (size_t i = BLOCKS_PER_SLAB; i-- > 0; ) {
+                free_blocks.push_back(&slab[i]);
+            }
+        }
+
+        void* acquire() {
+            std::lock_guard<Mutex> lock(mutex);
+            if (free_blocks.empty()) {
+                grow();
+            }
+            void* block = free_blocks.back();
+            free_blocks.pop_back();
+            return block;
+        }
+
+        void release(void* block) {
+            std::lock_guard<Mutex> lock(mutex);
+            free_blocks.push_back(block);
+        }
+    };
+
+    // Rebound by allocate_shared to its control-block type
+    template <typename T>
+    struct Allocator {
+        using value_type = T;
+
+        std::shared_ptr<Storage> storage;
+
+        explicit Allocator(std::shared_ptr<Storage> s) : storage(std::move(s)) {}
+        template <typename U>
+        Allocator(const Allocator<U>& other) : storage(other.storage) {}
+
+        T* allocate(size_t n) {
+            static_assert(sizeof(T) <= BLOCK_SIZE && alignof(T) <= alignof(Block),
+                          "OrderPool block too small");
+            if (n != 1) {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(storage->acquire());
+        }
+
+        void deallocate(T* p, size_t n) {
+            if (n != 1) {
+                ::operator delete(p);
+                return;
+            }
+            storage->release(p);
+        }
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const { return storage == other.storage; }
+        template <typename U>
+        bool operator!=(const Allocator<U>& other) const { return storage != other.storage; }
+    };
+
+    std::shared_ptr<Storage> storage_;
+};
+
+} // namespace MatchingEngine
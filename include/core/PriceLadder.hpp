@@ -0,0 +1,271 @@
+#pragma once
+
+#include "PriceLevel.hpp"
+#include <map>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+
+namespace MatchingEngine {
+
+// One side of an order book, ordered best-first.
+//
+// Levels within `window_ticks` of a movable base price live in a dense array
+// indexed by tick offset. A two-level occupancy bitmap (one bit per tick, one
+// summary bit per 64 ticks) finds the best and next level with ctz/clz. Levels
+// outside the window - and every level when window_ticks == 0 - live in a
+// sorted tree. The window recenters when a new level improves on everything
+// inside it, or when it drains while levels remain outside.
+template <OrderSide Side>
+class PriceLadder {
+public:
+    using Compare = std::conditional_t<Side == OrderSide::BUY,
+                                       std::greater<Price>, std::less<Price>>;
+
+    explicit PriceLadder(uint32_t window_ticks = 0)
+        : window_size_((static_cast<size_t>(window_ticks) + 63) & ~size_t(63)),
+          base_(0), window_count_(0), level_count_(0),
+          slots_(window_size_, nullptr),
+          words_(window_size_ / 64, 0),
+          summary_((window_size_ / 64 + 63) / 64, 0) {}
+
+    bool empty() const { return level_count_ == 0; }
+    size_t size() const { return level_count_; }
+    Price base() const { return base_; }
+    size_t windowSize() const { return window_size_; }
+
+    PriceLevel* find(Price price) const {
+        if (inWindow(price)) return slots_[index(price)];
+        auto it = overflow_.find(price);
+        return (it != overflow_.end()) ? it->second : nullptr;
+    }
+
+    PriceLevel& getOrCreate(Price price) {
+        if (PriceLevel* level = find(price)) return *level;
+
+        // A new touch outside the window drags the window with it
+        if (window_size_ > 0 && !inWindow(price) &&
+            (window_count_ == 0 || isBetter(price, slots_[windowBestIndex()]->price))) {
+            recenter(price);
+        }
+
+        PriceLevel* level = acquireLevel(price);
+        place(level);
+        level_count_++;
+        return *level;
+    }
+
+    // Remove a (drained) level
+    void erase(Price price) {
+        if (inWindow(price)) {
+            size_t i = index(price);
+            PriceLevel* level = slots_[i];
+            if (!level) return;
+            slots_[i] = nullptr;
+            clearBit(i);
+            window_count_--;
+            releaseLevel(level);
+        } else {
+            auto it = overflow_.find(price);
+            if (it == overflow_.end()) return;
+            releaseLevel(it->second);
+            overflow_.erase(it);
+        }
+        level_count_--;
+
+        if (window_size_ > 0 && window_count_ == 0 && !overflow_.empty()) {
+            recenter(overflow_.begin()->first);
+        }
+    }
+
+    PriceLevel* best() const {
+        if (window_count_ == 0) {
+            return overflow_.empty() ? nullptr : overflow_.begin()->second;
+        }
+        PriceLevel* window_best = slots_[windowBestIndex()];
+        if (!overflow_.empty() && isBetter(overflow_.begin()->first, window_best->price)) {
+            return overflow_.begin()->second;
+        }
+        return window_best;
+    }
+
+    // Visit levels best-first; fn(const PriceLevel&) returns false to stop
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        auto it = overflow_.begin();
+        if (window_count_ > 0) {
+            size_t i = windowBestIndex();
+            Price window_best = slots_[i]->price;
+            for (; it != overflow_.end() && isBetter(it->first, window_best); ++it) {
+                if (!fn(static_cast<const PriceLevel&>(*it->second))) return;
+            }
+            for (; i != NPOS; i = nextIndex(i)) {
+                if (!fn(static_cast<const PriceLevel&>(*slots_[i]))) return;
+            }
+        }
+        for (; it != overflow_.end(); ++it) {
+            if (!fn(static_cast<const PriceLevel&>(*it->second))) return;
+        }
+    }
+
+    // Move the window so that it is centred on `center`
+    void recenter(Price center) {
+        if (window_size_ == 0) return;
+
+        Price new_base = std::max<Price>(0, center - static_cast<Price>(window_size_ / 2));
+        if (new_base == base_ && window_count_ > 0) return;
+
+        // Spill the current window into the tree...
+        for (size_t s = 0; s < summary_.size(); ++s) {
+            uint64_t sbits = summary_[s];
+            while (sbits) {
+                size_t w = s * 64 + __builtin_ctzll(sbits);
+                sbits &= sbits - 1;
+                uint64_t bits = words_[w];
+                while (bits) {
+                    size_t i = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    overflow_.emplace(slots_[i]->price, slots_[i]);
+                    slots_[i] = nullptr;
+                }
+                words_[w] = 0;
+            }
+            summary_[s] = 0;
+        }
+        window_count_ = 0;
+        base_ = new_base;
+
+        // ...then pull the new range back out of it
+        Price lo = base_;
+        Price hi = base_ + static_cast<Price>(window_size_) - 1;
+        auto it = overflow_.lower_bound(Side == OrderSide::BUY ? hi : lo);
+        while (it != overflow_.end() && inWindow(it->first)) {
+            size_t i = index(it->first);
+            slots_[i] = it->second;
+            setBit(i);
+            window_count_++;
+            it = overflow_.erase(it);
+        }
+    }
+
+private:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    size_t window_size_;
+    Price base_;
+    size_t window_count_;
+    size_t level_count_;
+
+    std::vector<PriceLevel*> slots_;
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> summary_;
+    std::map<Price, PriceLevel*, Compare> overflow_;
+
+    std::vector<std::unique_ptr<PriceLevel>> level_storage_;
+    std::vector<PriceLevel*> free_levels_;
+
+    static bool isBetter(Price a, Price b) { return Compare{}(a, b); }
+
+    bool inWindow(Price price) const {
+        return price >= base_ && static_cast<size_t>(price - base_) < window_size_;
+    }
+
+    size_t index(Price price) const { return static_cast<size_t>(price - base_); }
+
+    void place(PriceLevel* level) {
+        if (inWindow(level->price)) {
+            size_t i = index(level->price);
+            slots_[i] = level;
+            setBit(i);
+            window_count_++;
+        } else {
+            overflow_.emplace(level->price, level);
+        }
+    }
+
+    void setBit(size_t i) {
+        size_t w = i / 64;
+        words_[w] |= (1ULL << (i % 64));
+        summary_[w / 64] |= (1ULL << (w % 64));
+    }
+
+    void clearBit(size_t i) {
+        size_t w = i / 64;
+        words_[w] &= ~(1ULL << (i % 64));
+        if (words_[w] == 0) {
+            summary_[w / 64] &= ~(1ULL << (w % 64));
+        }
+    }
+
+    // Lowest occupied index >= from
+    size_t scanUp(size_t from) const {
+        if (from >= window_size_) return NPOS;
+        size_t w = from / 64;
+        uint64_t bits = words_[w] & (~0ULL << (from % 64));
+        if (bits) return w * 64 + __builtin_ctzll(bits);
+
+        size_t next = w + 1;
+        if (next >= words_.size()) return NPOS;
+        size_t s = next / 64;
+        uint64_t sbits = summary_[s] & (~0ULL << (next % 64));
+        while (!sbits) {
+            if (++s >= summary_.size()) return NPOS;
+            sbits = summary_[s];
+        }
+        w = s * 64 + __builtin_ctzll(sbits);
+        return w * 64 + __builtin_ctzll(words_[w]);
+    }
+
+    // Highest occupied index <= from
+    size_t scanDown(size_t from) const {
+        if (window_size_ == 0) return NPOS;
+        size_t w = from / 64;
+        uint64_t bits = words_[w] & (~0ULL >> (63 - from % 64));
+        if (bits) return w * 64 + 63 - __builtin_clzll(bits);
+
+        if (w == 0) return NPOS;
+        size_t prev = w - 1;
+        size_t s = prev / 64;
+        uint64_t sbits = summary_[s] & (~0ULL >> (63 - prev % 64));
+        while (!sbits) {
+            if (s == 0) return NPOS;
+            sbits = summary_[--s];
+        }
+        w = s * 64 + 63 - __builtin_clzll(sbits);
+        return w * 64 + 63 - __builtin_clzll(words_[w]);
+    }
+
+    size_t windowBestIndex() const {
+        return (Side == OrderSide::BUY) ? scanDown(window_size_ - 1) : scanUp(0);
+    }
+
+    size_t nextIndex(size_t i) const {
+        if (Side == OrderSide::BUY) {
+            return (i == 0) ? NPOS : scanDown(i - 1);
+        }
+        return scanUp(i + 1);
+    }
+
+    PriceLevel* acquireLevel(Price price) {
+        PriceLevel* level;
+        if (!free_levels_.empty()) {
+            level = free_levels_.back();
+            free_levels_.pop_back();
+        } else {
+            level_storage_.push_back(std::make_unique<PriceLevel>());
+            level = level_storage_.back().get();
+        }
+        level->price = price;
+        level->total_quantity = 0;
+        return level;
+    }
+
+    void releaseLevel(PriceLevel* level) {
+        free_levels_.push_back(level);
+    }
+};
+
+} // namespace MatchingEngine
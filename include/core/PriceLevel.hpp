@@ -1,58 +1,107 @@
 #pragma once
 
 #include "Order.hpp"
-#include <deque>
-#include <algorithm>
 
 namespace MatchingEngine {
 
 // Minimal: Price level (FIFO queue of orders at a price)
+//
+// The queue is an intrusive doubly-linked list threaded through the resting
+// orders themselves, and each order keeps a handle back to its level, so
+// cancel and fill-removal are O(1) from the order alone. total_quantity and
+// order_count are maintained incrementally and never recomputed.
 class PriceLevel {
 public:
     Price price;
-    std::deque<OrderPtr> orders;  // FIFO queue
-    Quantity total_quantity;
+    Quantity total_quantity;  // Sum of remaining quantity of resting orders
+    uint32_t order_count;
     
-    explicit PriceLevel(Price p = 0.0) : price(p), total_quantity(0.0) {}
+    explicit PriceLevel(Price p = 0)
+        : price(p), total_quantity(0), order_count(0), head_(nullptr), tail_(nullptr) {}
     
-    void addOrder(OrderPtr order) {
-        orders.push_back(order);
+    PriceLevel(const PriceLevel&) = delete;
+    PriceLevel& operator=(const PriceLevel&) = delete;
+    
+    void addOrder(Order* order) {
+        order->level = this;
+        order->prev_in_level = tail_;
+        order->next_in_level = nullptr;
+        if (tail_) {
+            tail_->next_in_level = order;
+        } else {
+            head_ = order;
+        }
+        tail_ = order;
         total_quantity += order->remainingQuantity();
+        order_count++;
     }
     
-    bool removeOrder(const OrderId& order_id) {
-        auto it = std::find_if(orders.begin(), orders.end(),
-            [&](const OrderPtr& o) { return o->order_id == order_id; });
+    bool removeOrder(Order* order) {
+        if (order->level != this) return false;
         
-        if (it != orders.end()) {
-            total_quantity -= (*it)->remainingQuantity();
-            orders.erase(it);
-            return true;
+        total_quantity -= order->remainingQuantity();
+        if (order->prev_in_level) {
+            order->prev_in_level->next_in_level = order->next_in_level;
+        } else {
+            head_ = order->next_in_level;
+        }
+        if (order->next_in_level) {
+            order->next_in_level->prev_in_level = order->prev_in_level;
+        } else {
+            tail_ = order->prev_in_level;
         }
-        return false;
+        order->prev_in_level = nullptr;
+        order->next_in_level = nullptr;
+        order->level = nullptr;
+        order_count--;
+        return true;
     }
     
-    void updateQuantity() {
-        total_quantity = 0.0;
-        for (const auto& order : orders) {
-            total_quantity += order->remainingQuantity();
-        }
+    // A resting order on this level was filled by qty
+    void applyFill(Quantity qty) {
+        total_quantity -= qty;
     }
     
     bool isEmpty() const {
-        return orders.empty();
+        return head_ == nullptr;
     }
     
-    OrderPtr frontOrder() {
-        return orders.empty() ? nullptr : orders.front();
+    Order* frontOrder() const {
+        return head_;
     }
     
     void removeFrontOrder() {
-        if (!orders.empty()) {
-            total_quantity -= orders.front()->remainingQuantity();
-            orders.pop_front();
+        if (head_) {
+            removeOrder(head_);
         }
     }
+    
+    // Debug check: aggregates and linkage agree with the queue
+    bool checkConsistency() const {
+        Quantity quantity = 0;
+        uint32_t count = 0;
+        const Order* prev = nullptr;
+        for (const Order* order = head_; order; order = order->next_in_level) {
+            if (order->level != this || order->prev_in_level != prev) return false;
+            if (order->price != price || order->isFullyFilled()) return false;
+            quantity += order->remainingQuantity();
+            count++;
+            prev = order;
+        }
+        return prev == tail_ && quantity == total_quantity && count == order_count;
+    }
+    
+    // Visit orders in time priority; fn(const Order&)
+    template <typename Fn>
+    void forEachOrder(Fn&& fn) const {
+        for (const Order* order = head_; order; order = order->next_in_level) {
+            fn(*order);
+        }
+    }
+
+private:
+    Order* head_;
+    Order* tail_;
 };
 
 } // namespace MatchingEngine
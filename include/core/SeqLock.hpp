@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace MatchingEngine {
+
+// Single-writer sequence lock for a small trivially-copyable value.
+//
+// The writer makes the sequence odd, stores the payload, then makes it even
+// again; readers copy the payload between two sequence reads and retry if a
+// write overlapped. Readers never block the writer. The payload is held in
+// atomic words so a torn read is a retry, not a data race: a reader that
+// sees any word of a newer write also sees that write's odd sequence on its
+// second read. (On x86 every one of these is a plain mov.)
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+    
+public:
+    SeqLock() : SeqLock(T{}) {}
+    explicit SeqLock(const T& initial) : sequence_(0) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &initial, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+    
+    // Writer only (callers serialize writes, e.g. under the book lock)
+    void store(const T& value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        for (size_t i = 0; i < WORDS; ++i) words_[i].store(words[i], std::memory_order_release);
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+    
+    // Any thread
+    T load() const {
+        uint64_t words[WORDS];
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) continue;  // Write in progress
+            for (size_t i = 0; i < WORDS; ++i) words[i] = words_[i].load(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+    
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    
+    // Sequence and payload share one line, away from anything else the
+    // writer touches
+    alignas(64) std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> words_[WORDS];
+};
+
+} // namespace MatchingEngine
@@ -2,28 +2,86 @@
 
 #include "Order.hpp"
 #include "Types.hpp"
+#include "InstrumentedMutex.hpp"
 #include <vector>
 #include <memory>
 #include <map>
+#include <list>
+#include <unordered_map>
 #include <mutex>
+#include <atomic>
 
 // Minimal: Stop order management
 
 namespace MatchingEngine {
 
 class StopOrderManager {
+    using Mutex = InstrumentedMutex<LockSite::STOP_MANAGER>;
+
 public:
     StopOrderManager() = default;
     
-    void addStopOrder(OrderPtr order);
-    std::vector<OrderPtr> checkTriggers(const Symbol& symbol, Price last_trade_price);
-    bool cancelStopOrder(const OrderId& order_id);
-    std::vector<OrderPtr> getStopOrders(const Symbol& symbol) const;
-    size_t getStopOrderCount() const;
+    // Orders are referenced, not owned (the engine owns pending stops)
+    void addStopOrder(Order& order);
+    // Stops crossed by any trade priced within [low, high], converted to
+    // their executable type and removed, in arrival (order id) order
+    std::vector<Order*> checkTriggers(SymbolId symbol_id, Price low, Price high);
+    std::vector<Order*> checkTriggers(SymbolId symbol_id, Price last_trade_price) {
+        return checkTriggers(symbol_id, last_trade_price, last_trade_price);
+    }
+    bool cancelStopOrder(OrderId order_id);
+    bool contains(OrderId order_id) const;
+    
+    // Visit a symbol's pending stops in book order, without copying them
+    template <typename Fn>
+    void forEachStopOrder(SymbolId symbol_id, Fn&& fn) const {
+        std::lock_guard<Mutex> lock(mutex_);
+        auto it = stop_orders_.find(symbol_id);
+        if (it == stop_orders_.end()) return;
+        const SymbolStops& stops = it->second;
+        for (const StopBook* book : {&stops.buy_stops, &stops.sell_take_profits,
+                                     &stops.sell_stops, &stops.buy_take_profits}) {
+            for (const auto& level : *book) {
+                for (const Order* order : level.second) fn(*order);
+            }
+        }
+    }
+    
+    size_t getStopOrderCount() const { return total_count_.load(std::memory_order_relaxed); }
+    size_t getStopOrderCount(SymbolId symbol_id) const;
 
 private:
-    std::map<Symbol, std::vector<OrderPtr>> stop_orders_; // Stop orders by symbol
-    mutable std::mutex mutex_; 
+    // Stops sharing a trigger price, in arrival order. List nodes never move,
+    // so the index below can unlink any of them in O(1).
+    using StopLevel = std::list<Order*>;
+    using StopBook = std::map<Price, StopLevel>;
+    
+    // Per symbol, one book per side and trigger direction. "Rising" books
+    // fire once a trade prints at or above the key, "falling" books at or
+    // below it, so a trigger check is a range split rather than a scan.
+    struct SymbolStops {
+        StopBook buy_stops;          // Rising: stop-loss / stop-limit buys
+        StopBook sell_take_profits;  // Rising
+        StopBook sell_stops;         // Falling: stop-loss / stop-limit sells
+        StopBook buy_take_profits;   // Falling
+        size_t count = 0;
+    };
+    
+    // Where a pending stop sits, for cancel by id
+    struct StopLocation {
+        SymbolStops* stops;
+        StopBook* book;
+        StopBook::iterator level;
+        StopLevel::iterator node;
+    };
+    
+    static StopBook& bookFor(SymbolStops& stops, const Order& order);
+    static void activate(Order& order);
+    
+    std::unordered_map<SymbolId, SymbolStops> stop_orders_;
+    std::unordered_map<OrderId, StopLocation> index_;
+    std::atomic<size_t> total_count_{0};
+    mutable Mutex mutex_;
 };
 
 } // namespace MatchingEngine
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Types.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace MatchingEngine {
+
+// Interns symbol names to dense SymbolIds.
+//
+// Capacity is fixed at construction so entries never move: a published id
+// stays valid for the registry's lifetime and can index flat per-symbol
+// tables. Registration is serialised by a mutex; lookups by name or id never
+// lock - name lookups probe an open-addressing table whose slots are
+// published with release stores after the entry is fully written.
+class SymbolRegistry {
+public:
+    explicit SymbolRegistry(size_t capacity = Config::MAX_SYMBOLS);
+
+    SymbolRegistry(const SymbolRegistry&) = delete;
+    SymbolRegistry& operator=(const SymbolRegistry&) = delete;
+
+    // Id for `name`, registering it if new; INVALID_SYMBOL if the name is
+    // empty or the registry is full
+    SymbolId intern(const Symbol& name);
+
+    // Id for an already registered name; INVALID_SYMBOL otherwise
+    SymbolId find(const Symbol& name) const;
+
+    bool contains(SymbolId id) const { return id < size(); }
+    const Symbol& name(SymbolId id) const { return entries_[id].name; }
+
+    // Specs are configuration: set them before the symbol starts trading
+    void setSpec(SymbolId id, const SymbolSpec& spec);
+    const SymbolSpec& spec(SymbolId id) const { return entries_[id].spec; }
+
+    size_t size() const { return count_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Entry {
+        Symbol name;
+        SymbolSpec spec;
+    };
+
+    size_t capacity_;
+    size_t slot_mask_;
+    std::unique_ptr<Entry[]> entries_;
+    std::unique_ptr<std::atomic<uint32_t>[]> slots_;  // id + 1, 0 = empty
+    std::atomic<size_t> count_;
+    std::mutex write_mutex_;
+};
+
+} // namespace MatchingEngine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Order.hpp"
+#include "Types.hpp"
+#include <memory>
+
+namespace MatchingEngine {
+
+// Fixed-size history of orders that reached a terminal state.
+//
+// Records are compact by-value snapshots kept in a ring in retirement order,
+// so the oldest is always evicted first: when the ring is full, or once a
+// record is older than max_age. Lookups by id go through an open-addressing
+// index sized at construction, so nothing allocates or rehashes after
+// startup. Not synchronised; the engine guards it with its orders mutex.
+class TerminalOrderStore {
+public:
+    struct Record {
+        OrderId order_id = 0;
+        SymbolId symbol_id = 0;
+        OrderType type = OrderType::LIMIT;
+        OrderSide side = OrderSide::BUY;
+        OrderStatus status = OrderStatus::PENDING;
+        Price price = 0;
+        Price stop_price = 0;
+        Quantity quantity = 0;
+        Quantity filled_quantity = 0;
+        double average_fill_price = 0.0;
+        Timestamp timestamp = 0;   // Order's own timestamp
+        Timestamp retired_at = 0;  // Store clock, for age-based eviction
+    };
+
+    // max_age_ns = 0 keeps records until the ring wraps
+    explicit TerminalOrderStore(size_t capacity, uint64_t max_age_ns = 0);
+
+    TerminalOrderStore(const TerminalOrderStore&) = delete;
+    TerminalOrderStore& operator=(const TerminalOrderStore&) = delete;
+
+    // Records (or refreshes) an order's final state
+    void insert(const Order& order, Timestamp now);
+    // nullptr if never stored, evicted or expired
+    const Record* find(OrderId order_id, Timestamp now) const;
+    // Drop records older than max_age
+    void expire(Timestamp now);
+
+    static Order toOrder(const Record& record);
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return capacity_; }
+    uint64_t evicted() const { return evicted_; }
+
+private:
+    static constexpr uint32_t EMPTY = 0;  // Index slots hold ring position + 1
+
+    size_t capacity_;
+    uint64_t max_age_ns_;
+    std::unique_ptr<Record[]> ring_;
+    size_t head_ = 0;   // Oldest record
+    size_t count_ = 0;
+    uint64_t evicted_ = 0;
+
+    size_t index_mask_;
+    std::unique_ptr<uint32_t[]> index_;
+
+    size_t home(OrderId order_id) const;
+    size_t findSlot(OrderId order_id) const;  // Index slot, or npos
+    void unindex(size_t slot);
+    void evictOldest();
+    bool expired(const Record& record, Timestamp now) const;
+};
+
+} // namespace MatchingEngine
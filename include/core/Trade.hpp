@@ -2,47 +2,39 @@
 
 #include "Types.hpp"
 #include <string>
-#include <chrono>
 
 // Executed trade representation
 namespace MatchingEngine {
 
 class Trade {
 public:
-    std::string trade_id;
-    Symbol symbol;
+    TradeId trade_id;
+    SymbolId symbol_id;
     Price price;
     Quantity quantity;
     OrderId maker_order_id;
     OrderId taker_order_id;
     std::string aggressor_side;  // "buy" or "sell"
-    Timestamp timestamp;
+    Timestamp timestamp;         // Event time of the taker
+    bool maker_filled;           // This fill completed the maker order
     
-    double maker_fee;           // Fee charged to maker
-    double taker_fee;           // Fee charged to taker
+    double maker_fee;           // Fee charged to maker (notional units)
+    double taker_fee;           // Fee charged to taker (notional units)
     double maker_fee_rate;      // Maker fee rate
     double taker_fee_rate;      // Taker fee rate
     
-    Trade() : timestamp(getCurrentTimestamp()), 
+    Trade() : trade_id(0), symbol_id(Config::INVALID_SYMBOL), price(0), quantity(0), maker_order_id(0), taker_order_id(0),
+              timestamp(0), maker_filled(false),
               maker_fee(0.0), taker_fee(0.0), 
               maker_fee_rate(0.0), taker_fee_rate(0.0) {}
     
-    Trade(const std::string& tid, const Symbol& sym, Price p, Quantity q,
-          const OrderId& maker, const OrderId& taker, const std::string& aggressor)
-        : trade_id(tid), symbol(sym), price(p), quantity(q),
+    Trade(TradeId tid, SymbolId sym, Price p, Quantity q,
+          OrderId maker, OrderId taker, const std::string& aggressor, Timestamp ts)
+        : trade_id(tid), symbol_id(sym), price(p), quantity(q),
           maker_order_id(maker), taker_order_id(taker),
-          aggressor_side(aggressor), timestamp(getCurrentTimestamp()),
+          aggressor_side(aggressor), timestamp(ts), maker_filled(false),
           maker_fee(0.0), taker_fee(0.0), 
           maker_fee_rate(0.0), taker_fee_rate(0.0) {}
-    
-    std::string toJson() const;
-
-private:
-    static Timestamp getCurrentTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(
-            now.time_since_epoch()).count();
-    }
 };
 
 } // namespace MatchingEngine
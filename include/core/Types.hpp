@@ -3,7 +3,16 @@
 
 #include <string>
 #include <cstdint>
+#include <cstddef>
 #include <optional>
+#include <cassert>
+
+// Expensive invariant checks, enabled with `make DEBUG=1`
+#ifdef MATCHING_ENGINE_DEBUG
+#define ME_DEBUG_CHECK(expr) assert(expr)
+#else
+#define ME_DEBUG_CHECK(expr) ((void)0)
+#endif
 
 namespace MatchingEngine {
 
@@ -31,7 +40,8 @@ enum class OrderStatus {
     REJECTED
 };
 
-inline std::string orderTypeToString(OrderType type) {
+// Static storage, so it can be handed to the async logger
+inline const char* orderTypeName(OrderType type) {
     switch (type) {
         case OrderType::MARKET: return "MARKET";
         case OrderType::LIMIT: return "LIMIT";
@@ -44,6 +54,10 @@ inline std::string orderTypeToString(OrderType type) {
     }
 }
 
+inline std::string orderTypeToString(OrderType type) {
+    return orderTypeName(type);
+}
+
 inline std::string orderSideToString(OrderSide side) {
     return (side == OrderSide::BUY) ? "BUY" : "SELL";
 }
@@ -75,17 +89,29 @@ inline OrderSide stringToOrderSide(const std::string& str) {
     return (str == "buy") ? OrderSide::BUY : OrderSide::SELL;
 }
 
-using OrderId = std::string;
+using OrderId = uint64_t;   // 0 = not yet assigned
+using TradeId = uint64_t;
 using Symbol = std::string;
-using Price = double;
-using Quantity = double;
+using SymbolId = uint32_t;  // Dense index assigned by SymbolRegistry
+using Price = int64_t;      // Integer ticks (see SymbolSpec::tick_size)
+using Quantity = int64_t;   // Integer lots (see SymbolSpec::lot_size)
 using Timestamp = uint64_t;
 
 namespace Config {
-    constexpr int MAX_PRICE_DECIMALS = 2;
-    constexpr int MAX_QUANTITY_DECIMALS = 8;
-    constexpr double MIN_ORDER_SIZE = 0.00000001;
-    constexpr double EPSILON = 1e-9;
+    constexpr double DEFAULT_TICK_SIZE = 0.01;
+    constexpr double DEFAULT_LOT_SIZE = 0.00000001;
+    constexpr Quantity MIN_ORDER_LOTS = 1;
+    constexpr size_t MAX_SYMBOLS = 4096;
+    constexpr SymbolId INVALID_SYMBOL = 0xFFFFFFFF;
+    constexpr size_t DEPTH_LEVELS = 20;  // Levels per side in a book's depth image
 }
 
+// Per-symbol price/quantity grid. The core only ever sees integer ticks and
+// lots; decimal conversion happens at the API boundary (api/Messages.cpp).
+struct SymbolSpec {
+    double tick_size = Config::DEFAULT_TICK_SIZE;
+    double lot_size = Config::DEFAULT_LOT_SIZE;
+    uint32_t ladder_ticks = 0;  // Dense ladder window per side (0 = tree book)
+};
+
 } // namespace MatchingEngine
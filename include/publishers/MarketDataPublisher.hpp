@@ -6,12 +6,18 @@
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace MatchingEngine {
 namespace Publishers {
 
 /**
- * @brief Publishes L2 order book snapshots to WebSocket clients
+ * @brief Publishes L2 order book deltas to WebSocket clients, with periodic
+ * full snapshots of recently changed books for resync
  */
 class MarketDataPublisher {
 public:
@@ -20,7 +26,13 @@ public:
     
     void start();
     void stop();
-    void publishSnapshot(const Symbol& symbol);
+    void publishSnapshot(SymbolId symbol_id);
+    // Called from the engine's level update callback (matcher thread).
+    // Deltas go out in book-sequence order per symbol: inline matchers call
+    // this after releasing the book lock, so a later delta can arrive first
+    // and is held until the ones before it have been sent.
+    void publishLevelUpdates(SymbolId symbol_id, const std::vector<LevelUpdate>& updates);
+    // Resync snapshot period for books that changed since the last one
     void setUpdateInterval(int milliseconds) { update_interval_ms_ = milliseconds; }
 
 private:
@@ -30,7 +42,25 @@ private:
     std::thread publisher_thread_;
     int update_interval_ms_;
     
+    std::mutex changed_mutex_;
+    std::unordered_set<SymbolId> changed_symbols_;
+    
+    // Most deltas held back per symbol; past that the gap is given up on and
+    // clients resync from the next snapshot
+    static constexpr size_t MAX_HELD_DELTAS = 256;
+    struct HeldDelta {
+        uint64_t sequence;
+        std::string json;
+    };
+    struct DeltaStream {
+        uint64_t next_sequence = 1;              // Book versions start at 1
+        std::map<uint64_t, HeldDelta> held;      // By first_sequence
+    };
+    std::mutex streams_mutex_;
+    std::unordered_map<SymbolId, DeltaStream> streams_;
+    
     void publishLoop();
+    void broadcast(SymbolId symbol_id, const std::string& message);  // Timed
 };
 
 } // namespace Publishers
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/MatchingEngine.hpp"
 #include "core/Trade.hpp"
 #include "api/WebSocketServer.hpp"
 
@@ -11,11 +12,12 @@ namespace Publishers {
  */
 class TradePublisher {
 public:
-    TradePublisher(API::WebSocketServer& ws_server);
+    TradePublisher(MatchingEngineCore& engine, API::WebSocketServer& ws_server);
     
     void publishTrade(const Trade& trade);
 
 private:
+    MatchingEngineCore& engine_;
     API::WebSocketServer& ws_server_;
 };
 
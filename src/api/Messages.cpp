@@ -1,6 +1,11 @@
 #include "api/Messages.hpp"
 #include <sstream>
 #include <iomanip>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cinttypes>
+#include <stdexcept>
 
 namespace MatchingEngine {
 namespace API {
@@ -21,6 +26,110 @@ static std::string escapeJson(const std::string& str) {
     return oss.str();
 }
 
+// Number of decimals needed to print a multiple of step exactly
+static int decimalsFor(double step) {
+    int decimals = 0;
+    while (decimals < 12 && std::fabs(step - std::round(step)) > 1e-9 * step) {
+        step *= 10.0;
+        decimals++;
+    }
+    return decimals;
+}
+
+Price priceToTicks(double price, const SymbolSpec& spec) {
+    return static_cast<Price>(std::llround(price / spec.tick_size));
+}
+
+double ticksToPrice(double ticks, const SymbolSpec& spec) {
+    return ticks * spec.tick_size;
+}
+
+Quantity quantityToLots(double quantity, const SymbolSpec& spec) {
+    return static_cast<Quantity>(std::llround(quantity / spec.lot_size));
+}
+
+double lotsToQuantity(Quantity lots, const SymbolSpec& spec) {
+    return static_cast<double>(lots) * spec.lot_size;
+}
+
+double notionalToQuote(double notional, const SymbolSpec& spec) {
+    return notional * spec.tick_size * spec.lot_size;
+}
+
+bool isOnTick(double price, const SymbolSpec& spec) {
+    double ticks = price / spec.tick_size;
+    return std::fabs(ticks - std::round(ticks)) < 1e-6;
+}
+
+bool isOnLot(double quantity, const SymbolSpec& spec) {
+    double lots = quantity / spec.lot_size;
+    return std::fabs(lots - std::round(lots)) < 1e-6;
+}
+
+// 2^63 is exact as a double; anything below it rounds into int64
+static bool inInt64Range(double units) {
+    constexpr double limit = 9223372036854775808.0;
+    return std::isfinite(units) && units > -limit && units < limit;
+}
+
+bool inTickRange(double price, const SymbolSpec& spec) {
+    return inInt64Range(price / spec.tick_size);
+}
+
+bool inLotRange(double quantity, const SymbolSpec& spec) {
+    return inInt64Range(quantity / spec.lot_size);
+}
+
+std::string formatPrice(Price ticks, const SymbolSpec& spec) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(decimalsFor(spec.tick_size))
+        << ticksToPrice(static_cast<double>(ticks), spec);
+    return oss.str();
+}
+
+std::string formatQuantity(Quantity lots, const SymbolSpec& spec) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(decimalsFor(spec.lot_size))
+        << lotsToQuantity(lots, spec);
+    return oss.str();
+}
+
+std::string formatTimestamp(Timestamp ts) {
+    std::time_t time = static_cast<std::time_t>(ts / 1000000000);
+    std::tm tm_info;
+    gmtime_r(&time, &tm_info);  // REST and publisher threads format concurrently
+    
+    char time_buffer[80];
+    size_t len = std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%dT%H:%M:%S", &tm_info);
+    std::snprintf(time_buffer + len, sizeof(time_buffer) - len, ".%09" PRIu64 "Z", ts % 1000000000);
+    return time_buffer;
+}
+
+std::string formatOrderId(OrderId id) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "ORD%012" PRIu64, id);
+    return buffer;
+}
+
+std::string formatTradeId(const Symbol& symbol, TradeId id) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "_%010" PRIu64, id);
+    return symbol + buffer;
+}
+
+OrderId parseOrderId(const std::string& text) {
+    size_t pos = (text.compare(0, 3, "ORD") == 0) ? 3 : 0;
+    if (pos == text.size() || text.size() - pos > 19) return 0;
+
+    OrderId id = 0;
+    for (; pos < text.size(); ++pos) {
+        char c = text[pos];
+        if (c < '0' || c > '9') return 0;
+        id = id * 10 + static_cast<OrderId>(c - '0');
+    }
+    return id;
+}
+
 std::string OrderRequest::toJson() const {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(8);
@@ -63,7 +172,8 @@ OrderRequest OrderRequest::fromJson(const std::string& json) {
         } else {
             // Number value
             size_t end = start;
-            while (end < json.size() && (isdigit(json[end]) || json[end] == '.' || json[end] == '-')) end++;
+            while (end < json.size() && (isdigit(json[end]) || json[end] == '.' || json[end] == '-' ||
+                                         json[end] == '+' || json[end] == 'e' || json[end] == 'E')) end++;
             return json.substr(start, end - start);
         }
     };
@@ -76,14 +186,51 @@ OrderRequest OrderRequest::fromJson(const std::string& json) {
     std::string price_str = findValue("price");
     std::string stop_price_str = findValue("stop_price");
     
-    req.quantity = qty_str.empty() ? 0.0 : std::stod(qty_str);
-    req.price = price_str.empty() ? 0.0 : std::stod(price_str);
-    req.stop_price = stop_price_str.empty() ? 0.0 : std::stod(stop_price_str);
+    // Missing fields are 0; anything std::stod cannot take is a bad request
+    auto parseNumber = [](const std::string& text, const char* key) -> double {
+        if (text.empty()) return 0.0;
+        try {
+            return std::stod(text);
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument(std::string("Invalid number for ") + key);
+        }
+    };
+    req.quantity = parseNumber(qty_str, "quantity");
+    req.price = parseNumber(price_str, "price");
+    req.stop_price = parseNumber(stop_price_str, "stop_price");
     req.client_order_id = findValue("client_order_id");
     
     return req;
 }
 
+std::vector<OrderRequest> OrderRequest::fromJsonArray(const std::string& json) {
+    std::vector<OrderRequest> requests;
+    
+    // Cut out each top-level {...}, skipping braces inside strings
+    int depth = 0;
+    bool in_string = false;
+    size_t object_start = 0;
+    for (size_t i = 0; i < json.size(); ++i) {
+        char c = json[i];
+        if (in_string) {
+            if (c == '\\') i++;
+            else if (c == '"') in_string = false;
+            continue;
+        }
+        if (c == '"') {
+            in_string = true;
+        } else if (c == '{') {
+            if (depth++ == 0) object_start = i;
+        } else if (c == '}' && depth > 0) {
+            if (--depth == 0) {
+                requests.push_back(fromJson(json.substr(object_start, i - object_start + 1)));
+            }
+        }
+    }
+    
+    return requests;
+}
+
 std::string OrderResponse::toJson() const {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(8);
@@ -117,6 +264,7 @@ std::string OrderBookSnapshot::toJson() const {
     oss << "{";
     oss << "\"timestamp\":\"" << escapeJson(timestamp) << "\",";
     oss << "\"symbol\":\"" << escapeJson(symbol) << "\",";
+    oss << "\"sequence\":" << sequence << ",";
     
     oss << "\"bids\":[";
     for (size_t i = 0; i < bids.size(); ++i) {
@@ -136,6 +284,74 @@ std::string OrderBookSnapshot::toJson() const {
     return oss.str();
 }
 
+std::string OrderBookDelta::toJson() const {
+    std::ostringstream oss;
+    
+    oss << "{";
+    oss << "\"type\":\"l2update\",";
+    oss << "\"symbol\":\"" << escapeJson(symbol) << "\",";
+    oss << "\"first_sequence\":" << first_sequence << ",";
+    oss << "\"sequence\":" << sequence << ",";
+    
+    oss << "\"bids\":[";
+    for (size_t i = 0; i < bids.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "[\"" << bids[i].first << "\",\"" << bids[i].second << "\"]";
+    }
+    oss << "],";
+    
+    oss << "\"asks\":[";
+    for (size_t i = 0; i < asks.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "[\"" << asks[i].first << "\",\"" << asks[i].second << "\"]";
+    }
+    oss << "]";
+    
+    oss << "}";
+    return oss.str();
+}
+
+TradeReport TradeReport::fromTrade(const Trade& trade, const Symbol& symbol, const SymbolSpec& spec) {
+    TradeReport report;
+    report.timestamp = formatTimestamp(trade.timestamp);
+    report.symbol = symbol;
+    report.trade_id = formatTradeId(symbol, trade.trade_id);
+    report.price = ticksToPrice(static_cast<double>(trade.price), spec);
+    report.quantity = lotsToQuantity(trade.quantity, spec);
+    report.aggressor_side = trade.aggressor_side;
+    report.maker_order_id = formatOrderId(trade.maker_order_id);
+    report.taker_order_id = formatOrderId(trade.taker_order_id);
+    report.maker_fee = notionalToQuote(trade.maker_fee, spec);
+    report.taker_fee = notionalToQuote(trade.taker_fee, spec);
+    report.maker_fee_rate = trade.maker_fee_rate;
+    report.taker_fee_rate = trade.taker_fee_rate;
+    return report;
+}
+
+std::string TradeReport::toJson() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8);
+    
+    oss << "{";
+    oss << "\"timestamp\":\"" << timestamp << "\",";
+    oss << "\"symbol\":\"" << escapeJson(symbol) << "\",";
+    oss << "\"trade_id\":\"" << escapeJson(trade_id) << "\",";
+    oss << "\"price\":\"" << price << "\",";
+    oss << "\"quantity\":\"" << quantity << "\",";
+    oss << "\"aggressor_side\":\"" << aggressor_side << "\",";
+    oss << "\"maker_order_id\":\"" << escapeJson(maker_order_id) << "\",";
+    oss << "\"taker_order_id\":\"" << escapeJson(taker_order_id) << "\",";
+    
+    // Add fee information
+    oss << "\"maker_fee\":" << maker_fee << ",";
+    oss << "\"taker_fee\":" << taker_fee << ",";
+    oss << "\"maker_fee_rate\":" << maker_fee_rate << ",";
+    oss << "\"taker_fee_rate\":" << taker_fee_rate;
+    
+    oss << "}";
+    return oss.str();
+}
+
 std::string ErrorResponse::toJson() const {
     std::ostringstream oss;
     oss << "{";
@@ -2,17 +2,77 @@
 #include "core/Types.hpp"
 #include "core/FeeConfig.hpp"
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <cctype>
 #include <cstring>
 #include <iostream>
 #include <sstream>
-#include <chrono>
 #include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
 
 namespace MatchingEngine {
 namespace API {
 
+namespace {
+
+// Value of a request header (name matched case-insensitively), or "" if the
+// header is absent from request[0, header_end)
+std::string headerValue(const std::string& request, size_t header_end, const char* name) {
+    const size_t name_len = std::strlen(name);
+    size_t line = request.find("\r\n");
+    while (line != std::string::npos && line < header_end) {
+        line += 2;
+        size_t colon = line + name_len;
+        if (colon < header_end && request[colon] == ':' &&
+            std::equal(name, name + name_len, request.begin() + line,
+                       [](char a, char b) { return std::tolower(a) == std::tolower(b); })) {
+            size_t start = request.find_first_not_of(" \t", colon + 1);
+            size_t end = request.find("\r\n", colon);
+            if (start == std::string::npos || start >= end) return "";
+            return request.substr(start, end - start);
+        }
+        line = request.find("\r\n", line);
+    }
+    return "";
+}
+
+bool equalsIgnoreCase(const std::string& value, const char* expected) {
+    return value.size() == std::strlen(expected) &&
+           std::equal(value.begin(), value.end(), expected,
+                      [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+}
+
+bool writeAll(int socket, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        // MSG_NOSIGNAL: a client that hung up must not SIGPIPE the server
+        ssize_t n = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Prometheus label values escape backslash, quote and newline
+std::string escapeLabel(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+} // namespace
+
 RestAPIServer::RestAPIServer(MatchingEngineCore& engine, int port)
     : engine_(engine), port_(port), running_(false), server_socket_(-1) {}
 
@@ -71,7 +131,7 @@ void RestAPIServer::serverLoop() {
     }
     
     // Listen
-    if (listen(server_socket_, 10) < 0) {
+    if (listen(server_socket_, SOMAXCONN) < 0) {
         std::cerr << "Failed to listen on socket" << std::endl;
         close(server_socket_);
         return;
@@ -100,24 +160,68 @@ void RestAPIServer::serverLoop() {
 }
 
 void RestAPIServer::handleClient(int client_socket) {
-    char buffer[4096];
-    ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer) - 1);
-    
-    if (bytes_read <= 0) {
-        close(client_socket);
-        return;
-    }
+    // HTTP/1.1 connections persist until the client sends "Connection: close"
+    // (or speaks HTTP/1.0 without keep-alive), hangs up, or idles out.
+    // Requests are cut from one buffer, so pipelined requests are answered
+    // in order.
+    static constexpr size_t MAX_REQUEST_SIZE = 1 << 20;
+    static constexpr time_t IDLE_TIMEOUT_SECONDS = 30;
     
-    buffer[bytes_read] = '\0';
-    std::string request(buffer);
+    struct timeval idle_timeout{IDLE_TIMEOUT_SECONDS, 0};
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &idle_timeout, sizeof(idle_timeout));
     
-    std::string response = handleRequest(request);
+    std::string pending;
+    char buffer[4096];
+    bool open = true;
+    
+    while (open && running_) {
+        // Batch bodies can span several reads; keep reading until the
+        // headers and Content-Length bytes of body have arrived
+        size_t header_end = std::string::npos;
+        size_t expected = std::string::npos;
+        for (;;) {
+            if (expected == std::string::npos) {
+                header_end = pending.find("\r\n\r\n");
+                if (header_end != std::string::npos) {
+                    std::string length = headerValue(pending, header_end, "Content-Length");
+                    expected = header_end + 4 + std::strtoul(length.c_str(), nullptr, 10);
+                }
+            }
+            if (expected != std::string::npos && pending.size() >= expected) break;
+            if (pending.size() >= MAX_REQUEST_SIZE) {
+                open = false;
+                break;
+            }
+            ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer));
+            if (bytes_read <= 0) {
+                open = false;
+                break;
+            }
+            pending.append(buffer, static_cast<size_t>(bytes_read));
+        }
+        // A request cut short by the client is still answered, then closed
+        if (pending.empty()) break;
+        
+        size_t request_size = std::min(expected, pending.size());
+        std::string request = pending.substr(0, request_size);
+        pending.erase(0, request_size);
+        
+        if (open && header_end != std::string::npos) {
+            std::string connection = headerValue(request, header_end, "Connection");
+            std::string request_line = request.substr(0, request.find("\r\n"));
+            bool http10 = request_line.size() >= 8 &&
+                          request_line.compare(request_line.size() - 8, 8, "HTTP/1.0") == 0;
+            open = http10 ? equalsIgnoreCase(connection, "keep-alive")
+                          : !equalsIgnoreCase(connection, "close");
+        }
+        
+        if (!writeAll(client_socket, handleRequest(request, open))) break;
+    }
     
-    write(client_socket, response.c_str(), response.size());
     close(client_socket);
 }
 
-std::string RestAPIServer::handleRequest(const std::string& request) {
+std::string RestAPIServer::handleRequest(const std::string& request, bool keep_alive) {
     std::istringstream iss(request);
     std::string method, path, version;
     iss >> method >> path >> version;
@@ -138,6 +242,9 @@ std::string RestAPIServer::handleRequest(const std::string& request) {
         if (method == "POST" && path == "/api/v1/orders") {
             response_body = handleOrderSubmit(body);
         }
+        else if (method == "POST" && path == "/api/v1/orders/batch") {
+            response_body = handleOrderBatchSubmit(body);
+        }
         else if (method == "DELETE" && path.find("/api/v1/orders/") == 0) {
             std::string order_id = path.substr(15);
             response_body = handleOrderCancel(order_id);
@@ -150,12 +257,26 @@ std::string RestAPIServer::handleRequest(const std::string& request) {
             std::string symbol = path.substr(18);
             response_body = handleOrderBookQuery(symbol);
         }
+        else if (method == "GET" && path.find("/api/v1/bbo/") == 0) {
+            std::string symbol = path.substr(12);
+            response_body = handleBBOQuery(symbol);
+        }
+        else if (method == "GET" && path == "/metrics") {
+            content_type = "text/plain; version=0.0.4";
+            response_body = handleMetrics();
+        }
         else {
             status_code = 404;
             status_text = "Not Found";
             ErrorResponse err{"not_found", "Endpoint not found"};
             response_body = err.toJson();
         }
+    } catch (const std::logic_error& e) {
+        // Unparseable or out-of-range numbers (std::stod, buildOrder)
+        status_code = 400;
+        status_text = "Bad Request";
+        ErrorResponse err{"bad_request", e.what()};
+        response_body = err.toJson();
     } catch (const std::exception& e) {
         status_code = 500;
         status_text = "Internal Server Error";
@@ -169,7 +290,7 @@ std::string RestAPIServer::handleRequest(const std::string& request) {
     response << "Content-Type: " << content_type << "\r\n";
     response << "Content-Length: " << response_body.size() << "\r\n";
     response << "Access-Control-Allow-Origin: *\r\n";
-    response << "Connection: close\r\n";
+    response << "Connection: " << (keep_alive ? "keep-alive" : "close") << "\r\n";
     response << "\r\n";
     response << response_body;
     
@@ -177,16 +298,95 @@ std::string RestAPIServer::handleRequest(const std::string& request) {
 }
 
 std::string RestAPIServer::handleOrderSubmit(const std::string& body) {
+    LatencyMetrics& metrics = engine_.latencyMetrics();
+    uint64_t started = metrics.start();
     OrderRequest req = OrderRequest::fromJson(body);
     
-    // Create order
-    auto order = std::make_shared<Order>(
-        "",
-        req.symbol,
+    OrderResponse resp;
+    auto order = buildOrder(req, resp);
+    if (!order) {
+        metrics.recordSince(LatencyStage::REST_PARSE, Config::INVALID_SYMBOL,
+                            LatencyMetrics::NO_ORDER_TYPE, started);
+        return resp.toJson();
+    }
+    metrics.recordSince(LatencyStage::REST_PARSE, order->symbol_id, order->type, started);
+    
+    // Submit to engine
+    OrderId order_id = engine_.submitOrder(order);
+    return makeSubmitResponse(*order, order_id).toJson();
+}
+
+std::string RestAPIServer::handleOrderBatchSubmit(const std::string& body) {
+    LatencyMetrics& metrics = engine_.latencyMetrics();
+    uint64_t started = metrics.start();
+    std::vector<OrderRequest> reqs = OrderRequest::fromJsonArray(body);
+    
+    // Orders that fail the API checks keep their slot in the response but
+    // never reach the engine
+    std::vector<OrderResponse> responses(reqs.size());
+    std::vector<OrderPtr> orders;
+    std::vector<size_t> positions;
+    orders.reserve(reqs.size());
+    positions.reserve(reqs.size());
+    for (size_t i = 0; i < reqs.size(); ++i) {
+        auto order = buildOrder(reqs[i], responses[i]);
+        if (!order) continue;
+        orders.push_back(std::move(order));
+        positions.push_back(i);
+    }
+    // A batch mixes symbols and types, so it is timed as a whole
+    metrics.recordSince(LatencyStage::REST_PARSE, Config::INVALID_SYMBOL,
+                        LatencyMetrics::NO_ORDER_TYPE, started);
+    
+    std::vector<OrderId> order_ids = engine_.submitOrders(orders);
+    for (size_t k = 0; k < orders.size(); ++k) {
+        responses[positions[k]] = makeSubmitResponse(*orders[k], order_ids[k]);
+    }
+    
+    std::ostringstream oss;
+    oss << "[";
+    for (size_t i = 0; i < responses.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << responses[i].toJson();
+    }
+    oss << "]";
+    return oss.str();
+}
+
+OrderPtr RestAPIServer::buildOrder(const OrderRequest& req, OrderResponse& resp) {
+    // Symbols come from the server's configuration; clients never add them
+    SymbolId symbol_id = engine_.findSymbol(req.symbol);
+    if (symbol_id == Config::INVALID_SYMBOL) {
+        resp.success = false;
+        resp.message = "Unknown symbol";
+        resp.status = "REJECTED";
+        return nullptr;
+    }
+    SymbolSpec spec = engine_.getSymbolSpec(symbol_id);
+    
+    // A bad request rather than a rejection: these never reach llround
+    if (!inTickRange(req.price, spec) || !inTickRange(req.stop_price, spec) ||
+        !inLotRange(req.quantity, spec)) {
+        throw std::out_of_range("Price or quantity out of range");
+    }
+    
+    // Prices and quantities must sit on the symbol's tick/lot grid
+    if (!isOnTick(req.price, spec) || !isOnTick(req.stop_price, spec) ||
+        !isOnLot(req.quantity, spec)) {
+        resp.success = false;
+        resp.message = "Price or quantity not a multiple of tick/lot size";
+        resp.status = "REJECTED";
+        return nullptr;
+    }
+    
+    // Create order (pooled)
+    auto order = engine_.createOrder(
+        0,
+        symbol_id,
         stringToOrderType(req.order_type),
         stringToOrderSide(req.side),
-        req.price,
-        req.quantity
+        priceToTicks(req.price, spec),
+        quantityToLots(req.quantity, spec)
     );
     
     if (!req.client_order_id.empty()) {
@@ -195,36 +395,38 @@ std::string RestAPIServer::handleOrderSubmit(const std::string& body) {
     
     // Set stop price for stop orders
     if (req.stop_price > 0.0) {
-        order->stop_price = req.stop_price;
+        order->stop_price = priceToTicks(req.stop_price, spec);
     }
     
-    // Submit to engine
-    std::string order_id = engine_.submitOrder(order);
-    
+    return order;
+}
+
+OrderResponse RestAPIServer::makeSubmitResponse(const Order& order, OrderId order_id) {
     OrderResponse resp;
-    if (!order_id.empty()) {
+    if (order_id != 0) {
+        SymbolSpec spec = engine_.getSymbolSpec(order.symbol_id);
         resp.success = true;
-        resp.order_id = order_id;
+        resp.order_id = formatOrderId(order_id);
         resp.message = "Order accepted";
-        resp.status = orderStatusToString(order->status);
+        resp.status = orderStatusToString(order.status);
         
         // If order was filled, include trade information with fees
-        if (order->status == OrderStatus::FILLED || 
-            order->status == OrderStatus::PARTIAL_FILL) {
+        if (order.status == OrderStatus::FILLED || 
+            order.status == OrderStatus::PARTIAL_FILL) {
             
-            if (order->filled_quantity > 0.0) {
+            if (order.filled_quantity > 0) {
                 resp.has_trade = true;
-                resp.trade_quantity = order->filled_quantity;
+                resp.trade_quantity = lotsToQuantity(order.filled_quantity, spec);
                 
                 // Use actual average fill price (not order price)
-                resp.trade_price = order->average_fill_price;
+                resp.trade_price = ticksToPrice(order.average_fill_price, spec);
                 
                 // Calculate fees based on filled amount
                 double trade_value = resp.trade_price * resp.trade_quantity;
-                resp.maker_fee = trade_value * 0.001;  // 0.1%
-                resp.taker_fee = trade_value * 0.002;  // 0.2%
-                resp.maker_fee_rate = 0.001;
-                resp.taker_fee_rate = 0.002;
+                resp.maker_fee = trade_value * FeeConfig::MAKER_FEE_RATE;
+                resp.taker_fee = trade_value * FeeConfig::TAKER_FEE_RATE;
+                resp.maker_fee_rate = FeeConfig::MAKER_FEE_RATE;
+                resp.taker_fee_rate = FeeConfig::TAKER_FEE_RATE;
             }
         }
     } else {
@@ -234,11 +436,11 @@ std::string RestAPIServer::handleOrderSubmit(const std::string& body) {
         resp.status = "REJECTED";
     }
     
-    return resp.toJson();
+    return resp;
 }
 
 std::string RestAPIServer::handleOrderCancel(const std::string& order_id) {
-    bool cancelled = engine_.cancelOrder(order_id);
+    bool cancelled = engine_.cancelOrder(parseOrderId(order_id));
     
     OrderResponse resp;
     resp.success = cancelled;
@@ -250,23 +452,25 @@ std::string RestAPIServer::handleOrderCancel(const std::string& order_id) {
 }
 
 std::string RestAPIServer::handleOrderQuery(const std::string& order_id) {
-    auto order = engine_.getOrder(order_id);
+    auto order = engine_.getOrder(parseOrderId(order_id));
     
     if (!order) {
         ErrorResponse err{"not_found", "Order not found"};
         return err.toJson();
     }
     
+    SymbolSpec spec = engine_.getSymbolSpec(order->symbol_id);
+    
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(8);
     oss << "{";
-    oss << "\"order_id\":\"" << order->order_id << "\",";
-    oss << "\"symbol\":\"" << order->symbol << "\",";
+    oss << "\"order_id\":\"" << formatOrderId(order->order_id) << "\",";
+    oss << "\"symbol\":\"" << engine_.getSymbolName(order->symbol_id) << "\",";
     oss << "\"type\":\"" << orderTypeToString(order->type) << "\",";
     oss << "\"side\":\"" << orderSideToString(order->side) << "\",";
-    oss << "\"price\":" << order->price << ",";
-    oss << "\"quantity\":" << order->quantity << ",";
-    oss << "\"filled_quantity\":" << order->filled_quantity << ",";
+    oss << "\"price\":" << ticksToPrice(static_cast<double>(order->price), spec) << ",";
+    oss << "\"quantity\":" << lotsToQuantity(order->quantity, spec) << ",";
+    oss << "\"filled_quantity\":" << lotsToQuantity(order->filled_quantity, spec) << ",";
     oss << "\"status\":\"" << orderStatusToString(order->status) << "\"";
     oss << "}";
     
@@ -274,50 +478,109 @@ std::string RestAPIServer::handleOrderQuery(const std::string& order_id) {
 }
 
 std::string RestAPIServer::handleOrderBookQuery(const std::string& symbol) {
-    auto book = engine_.getOrderBook(symbol);
+    OrderBook* book = engine_.getOrderBook(engine_.findSymbol(symbol));
     
     if (!book) {
         ErrorResponse err{"not_found", "Symbol not found"};
         return err.toJson();
     }
     
-    auto bids = book->getBids(10);
-    auto asks = book->getAsks(10);
+    // One consistent image of both sides, read without the book lock
+    DepthImage depth = book->getDepth();
+    const uint32_t bid_levels = std::min<uint32_t>(depth.bid_count, 10);
+    const uint32_t ask_levels = std::min<uint32_t>(depth.ask_count, 10);
+    
+    OrderBookSnapshot snapshot;
+    snapshot.timestamp = formatTimestamp(engine_.clock().now());
+    snapshot.symbol = symbol;
     
-    // Get current timestamp
-    auto now = std::chrono::system_clock::now();
-    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-    auto now_sec = now_ns / 1000000000;
-    auto now_nsec = now_ns % 1000000000;
+    const SymbolSpec& spec = book->getSpec();
+    snapshot.sequence = depth.sequence;
+    for (uint32_t i = 0; i < bid_levels; ++i) {
+        snapshot.bids.emplace_back(formatPrice(depth.bids[i].price, spec),
+                                   formatQuantity(depth.bids[i].quantity, spec));
+    }
     
-    std::time_t time = static_cast<std::time_t>(now_sec);
-    std::tm* tm_info = std::gmtime(&time);
+    for (uint32_t i = 0; i < ask_levels; ++i) {
+        snapshot.asks.emplace_back(formatPrice(depth.asks[i].price, spec),
+                                   formatQuantity(depth.asks[i].quantity, spec));
+    }
     
-    char time_buffer[80];
-    std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%dT%H:%M:%S", tm_info);
+    return snapshot.toJson();
+}
+
+std::string RestAPIServer::handleBBOQuery(const std::string& symbol) {
+    SymbolId symbol_id = engine_.findSymbol(symbol);
+    OrderBook* book = engine_.getOrderBook(symbol_id);
     
-    std::ostringstream timestamp;
-    timestamp << time_buffer << "." << std::setfill('0') << std::setw(9) << now_nsec << "Z";
+    if (!book) {
+        ErrorResponse err{"not_found", "Symbol not found"};
+        return err.toJson();
+    }
     
-    OrderBookSnapshot snapshot;
-    snapshot.timestamp = timestamp.str();
-    snapshot.symbol = symbol;
+    // Seqlock read: never waits on the matcher
+    TopOfBook top = book->getTopOfBook();
+    const SymbolSpec& spec = book->getSpec();
     
-    for (const auto& [price, qty] : bids) {
-        std::ostringstream p, q;
-        p << std::fixed << std::setprecision(2) << price;
-        q << std::fixed << std::setprecision(8) << qty;
-        snapshot.bids.emplace_back(p.str(), q.str());
+    std::ostringstream oss;
+    oss << "{";
+    oss << "\"symbol\":\"" << symbol << "\",";
+    oss << "\"sequence\":" << top.sequence << ",";
+    oss << "\"bid\":";
+    if (top.hasBid()) {
+        oss << "[\"" << formatPrice(top.bid_price, spec) << "\",\""
+            << formatQuantity(top.bid_quantity, spec) << "\"]";
+    } else {
+        oss << "null";
+    }
+    oss << ",\"ask\":";
+    if (top.hasAsk()) {
+        oss << "[\"" << formatPrice(top.ask_price, spec) << "\",\""
+            << formatQuantity(top.ask_quantity, spec) << "\"]";
+    } else {
+        oss << "null";
     }
+    oss << "}";
+    
+    return oss.str();
+}
+
+// Prometheus text exposition: one summary series per stage/symbol/type seen
+std::string RestAPIServer::handleMetrics() {
+    static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
     
-    for (const auto& [price, qty] : asks) {
-        std::ostringstream p, q;
-        p << std::fixed << std::setprecision(2) << price;
-        q << std::fixed << std::setprecision(8) << qty;
-        snapshot.asks.emplace_back(p.str(), q.str());
+    std::ostringstream oss;
+    oss << "# HELP matching_engine_latency_ns Order lifecycle stage latency in nanoseconds\n";
+    oss << "# TYPE matching_engine_latency_ns summary\n";
+    for (const auto& series : engine_.latencyMetrics().snapshot()) {
+        std::string labels = std::string("stage=\"") + latencyStageName(series.stage) + "\"";
+        if (series.symbol_id != Config::INVALID_SYMBOL) {
+            labels += ",symbol=\"" + escapeLabel(engine_.getSymbolName(series.symbol_id)) + "\"";
+        }
+        if (series.order_type != LatencyMetrics::NO_ORDER_TYPE) {
+            labels += std::string(",order_type=\"") +
+                      orderTypeName(static_cast<OrderType>(series.order_type)) + "\"";
+        }
+        
+        const auto& hist = series.histogram;
+        for (double q : QUANTILES) {
+            oss << "matching_engine_latency_ns{" << labels << ",quantile=\"" << q << "\"} "
+                << hist.percentile(q) << "\n";
+        }
+        oss << "matching_engine_latency_ns_sum{" << labels << "} " << hist.sum << "\n";
+        oss << "matching_engine_latency_ns_count{" << labels << "} " << hist.count << "\n";
     }
     
-    return snapshot.toJson();
+    oss << "# HELP matching_engine_orders_processed_total Orders processed by the engine\n";
+    oss << "# TYPE matching_engine_orders_processed_total counter\n";
+    oss << "matching_engine_orders_processed_total " << engine_.getTotalOrdersProcessed() << "\n";
+    oss << "# HELP matching_engine_trades_executed_total Trades executed by the engine\n";
+    oss << "# TYPE matching_engine_trades_executed_total counter\n";
+    oss << "matching_engine_trades_executed_total " << engine_.getTotalTradesExecuted() << "\n";
+    oss << "# HELP matching_engine_live_orders Orders resting or waiting on a stop trigger\n";
+    oss << "# TYPE matching_engine_live_orders gauge\n";
+    oss << "matching_engine_live_orders " << engine_.getLiveOrderCount() << "\n";
+    return oss.str();
 }
 
 } // namespace API
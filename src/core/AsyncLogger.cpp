@@ -0,0 +1,179 @@
+#include "core/AsyncLogger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+
+namespace MatchingEngine {
+
+static std::atomic<uint64_t> next_logger_id{1};
+
+static size_t roundUpPow2(size_t n) {
+    size_t size = 2;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+AsyncLogger::Ring::Ring(size_t capacity)
+    : mask(roundUpPow2(capacity) - 1), records(new Record[mask + 1]) {}
+
+AsyncLogger::AsyncLogger(FILE* out, size_t ring_capacity)
+    : out_(out), ring_capacity_(ring_capacity),
+      id_(next_logger_id.fetch_add(1, std::memory_order_relaxed)) {
+    writer_ = std::thread(&AsyncLogger::writerLoop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    running_.store(false, std::memory_order_release);
+    if (writer_.joinable()) writer_.join();
+}
+
+AsyncLogger& AsyncLogger::instance() {
+    static AsyncLogger logger(stdout);
+    return logger;
+}
+
+AsyncLogger::ThreadRings::~ThreadRings() {
+    for (auto& entry : rings) entry.second->retired.store(true, std::memory_order_release);
+}
+
+// The owning thread finds its ring through a one-entry thread-local cache;
+// registration (first record from a thread) is the only locked step
+AsyncLogger::Ring* AsyncLogger::ringForThisThread() {
+    thread_local ThreadRings owned;
+    thread_local uint64_t cached_id = 0;
+    thread_local Ring* cached_ring = nullptr;
+    if (cached_id == id_) return cached_ring;
+
+    Ring* ring = nullptr;
+    for (auto& entry : owned.rings) {
+        if (entry.first == id_) ring = entry.second.get();
+    }
+    if (!ring) {
+        auto created = std::make_shared<Ring>(ring_capacity_);
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings_.push_back(created);
+        }
+        owned.rings.emplace_back(id_, created);
+        ring = created.get();
+    }
+    cached_id = id_;
+    cached_ring = ring;
+    return ring;
+}
+
+void AsyncLogger::push(const Record& record) {
+    Ring* ring = ringForThisThread();
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->head.load(std::memory_order_acquire) > ring->mask) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring->records[tail & ring->mask] = record;
+    ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+void AsyncLogger::format(const Record& record, std::string& out) {
+    if (record.level == LogLevel::WARN) out += "[WARN] ";
+    if (record.level == LogLevel::ERROR) out += "[ERROR] ";
+
+    char number[32];
+    size_t next = 0;
+    for (const char* p = record.format; *p; ++p) {
+        if (p[0] != '{' || p[1] != '}' || next >= record.arg_count) {
+            out += *p;
+            continue;
+        }
+        const Record::Arg& arg = record.args[next];
+        switch (record.types[next]) {
+            case Record::INT:
+                snprintf(number, sizeof(number), "%" PRId64, arg.i);
+                out += number;
+                break;
+            case Record::UINT:
+                snprintf(number, sizeof(number), "%" PRIu64, arg.u);
+                out += number;
+                break;
+            case Record::DOUBLE:
+                snprintf(number, sizeof(number), "%.17g", arg.d);  // Round-trips
+                out += number;
+                break;
+            case Record::STRING:
+                out += arg.s ? arg.s : "(null)";
+                break;
+        }
+        next++;
+        p++;
+    }
+    out += '\n';
+}
+
+std::vector<std::shared_ptr<AsyncLogger::Ring>> AsyncLogger::snapshotRings() {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    return rings_;
+}
+
+size_t AsyncLogger::ringCount() {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    return rings_.size();
+}
+
+// Heads only advance once the text is flushed, so flush() can wait on them.
+// A ring retired before its tail was read is empty once drained, and freed.
+size_t AsyncLogger::drain(std::string& buffer) {
+    std::vector<std::shared_ptr<Ring>> rings = snapshotRings();
+    std::vector<uint64_t> tails(rings.size());
+    std::vector<Ring*> retired;
+
+    size_t count = 0;
+    buffer.clear();
+    for (size_t r = 0; r < rings.size(); ++r) {
+        Ring* ring = rings[r].get();
+        if (ring->retired.load(std::memory_order_acquire)) retired.push_back(ring);
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        tails[r] = ring->tail.load(std::memory_order_acquire);
+        for (; head != tails[r]; ++head, ++count) {
+            format(ring->records[head & ring->mask], buffer);
+        }
+    }
+
+    if (count > 0) {
+        fwrite(buffer.data(), 1, buffer.size(), out_);
+        fflush(out_);
+        for (size_t r = 0; r < rings.size(); ++r) {
+            rings[r]->head.store(tails[r], std::memory_order_release);
+        }
+    }
+    if (!retired.empty()) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                    [&](const std::shared_ptr<Ring>& ring) {
+                                        return std::find(retired.begin(), retired.end(),
+                                                         ring.get()) != retired.end();
+                                    }),
+                     rings_.end());
+    }
+    return count;
+}
+
+void AsyncLogger::writerLoop() {
+    std::string buffer;
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain(buffer) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    while (drain(buffer) > 0) {}
+}
+
+void AsyncLogger::flush() {
+    for (const auto& ring : snapshotRings()) {
+        uint64_t target = ring->tail.load(std::memory_order_acquire);
+        while (ring->head.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+} // namespace MatchingEngine
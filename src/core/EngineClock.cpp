@@ -0,0 +1,52 @@
+#include "core/EngineClock.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace MatchingEngine {
+
+EngineClock::EngineClock(ClockSource source)
+    : source_(source), manual_(0) {
+#ifdef ME_HAVE_TSC
+    if (source_ != ClockSource::TSC) return;
+    
+    // Initial fit over a short sleep; recalibrate() refines it later
+    Calibration cal;
+    cal.base_ticks = __rdtsc();
+    cal.base_ns = systemNow();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t ticks = __rdtsc() - cal.base_ticks;
+    uint64_t ns = systemNow() - cal.base_ns;
+    if (ticks == 0 || ns == 0) {
+        source_ = ClockSource::SYSTEM;
+        return;
+    }
+    cal.ns_per_tick_q32 = static_cast<uint64_t>((static_cast<unsigned __int128>(ns) << 32) / ticks);
+    calibration_.store(cal);
+#else
+    if (source_ == ClockSource::TSC) source_ = ClockSource::SYSTEM;
+#endif
+}
+
+void EngineClock::recalibrate() {
+#ifdef ME_HAVE_TSC
+    if (source_ != ClockSource::TSC) return;
+    
+    Calibration old = calibration_.load();
+    uint64_t tsc = __rdtsc();
+    Timestamp wall = systemNow();
+    uint64_t ticks = tsc - old.base_ticks;
+    if (ticks == 0 || wall <= old.base_ns) return;  // Wall clock stepped back
+    
+    Timestamp extrapolated = old.base_ns + static_cast<Timestamp>(
+        (static_cast<unsigned __int128>(ticks) * old.ns_per_tick_q32) >> 32);
+    
+    Calibration cal;
+    cal.base_ticks = tsc;
+    cal.base_ns = std::max(wall, extrapolated);
+    cal.ns_per_tick_q32 = static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(wall - old.base_ns) << 32) / ticks);
+    calibration_.store(cal);
+#endif
+}
+
+} // namespace MatchingEngine
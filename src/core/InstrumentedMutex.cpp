@@ -0,0 +1,115 @@
+#include "core/InstrumentedMutex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace MatchingEngine {
+
+const char* lockSiteName(LockSite site) {
+    switch (site) {
+        case LockSite::ORDERS: return "orders";
+        case LockSite::ORDER_BOOKS: return "order_books";
+        case LockSite::BOOK: return "book";
+        case LockSite::STOP_MANAGER: return "stop_manager";
+        case LockSite::TRIGGER_QUEUE: return "trigger_queue";
+        case LockSite::ORDER_POOL: return "order_pool";
+        default: return "unknown";
+    }
+}
+
+namespace {
+
+// Written only by the owning thread; relaxed atomics so snapshot() can read
+// them concurrently
+struct SiteCounters {
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> wait_ns{0};
+    std::atomic<uint64_t> max_wait_ns{0};
+    std::atomic<uint64_t> hold_ns{0};
+};
+
+struct ThreadCounters {
+    SiteCounters sites[LockStats::SITES];
+};
+
+void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// Counters outlive their thread so totals survive short-lived workers
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+std::vector<std::shared_ptr<ThreadCounters>>& registry() {
+    static std::vector<std::shared_ptr<ThreadCounters>> threads;
+    return threads;
+}
+
+ThreadCounters& local() {
+    thread_local ThreadCounters* counters = [] {
+        auto owned = std::make_shared<ThreadCounters>();
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(owned);
+        return owned.get();
+    }();
+    return *counters;
+}
+
+} // namespace
+
+uint64_t LockStats::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void LockStats::acquired(LockSite site, uint64_t wait_ns, bool contended) {
+    SiteCounters& counters = local().sites[static_cast<size_t>(site)];
+    bump(counters.acquisitions, 1);
+    if (!contended) return;
+    bump(counters.contended, 1);
+    bump(counters.wait_ns, wait_ns);
+    if (wait_ns > counters.max_wait_ns.load(std::memory_order_relaxed)) {
+        counters.max_wait_ns.store(wait_ns, std::memory_order_relaxed);
+    }
+}
+
+void LockStats::released(LockSite site, uint64_t hold_ns) {
+    bump(local().sites[static_cast<size_t>(site)].hold_ns, hold_ns);
+}
+
+std::array<LockSiteStats, LockStats::SITES> LockStats::snapshot() {
+    std::array<LockSiteStats, SITES> out{};
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (const auto& thread : registry()) {
+        for (size_t i = 0; i < SITES; ++i) {
+            const SiteCounters& in = thread->sites[i];
+            out[i].acquisitions += in.acquisitions.load(std::memory_order_relaxed);
+            out[i].contended += in.contended.load(std::memory_order_relaxed);
+            out[i].wait_ns += in.wait_ns.load(std::memory_order_relaxed);
+            out[i].max_wait_ns = std::max(out[i].max_wait_ns, in.max_wait_ns.load(std::memory_order_relaxed));
+            out[i].hold_ns += in.hold_ns.load(std::memory_order_relaxed);
+        }
+    }
+    return out;
+}
+
+// Only exact while no instrumented lock is being taken: a concurrent owner
+// can overwrite the reset with its stale value plus one
+void LockStats::reset() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (const auto& thread : registry()) {
+        for (SiteCounters& counters : thread->sites) {
+            counters.acquisitions.store(0, std::memory_order_relaxed);
+            counters.contended.store(0, std::memory_order_relaxed);
+            counters.wait_ns.store(0, std::memory_order_relaxed);
+            counters.max_wait_ns.store(0, std::memory_order_relaxed);
+            counters.hold_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace MatchingEngine
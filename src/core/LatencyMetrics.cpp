@@ -0,0 +1,169 @@
+#include "core/LatencyMetrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace MatchingEngine {
+
+const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::REST_PARSE: return "rest_parse";
+        case LatencyStage::VALIDATE: return "validate";
+        case LatencyStage::MATCH: return "match";
+        case LatencyStage::STOP_TRIGGER: return "stop_trigger";
+        case LatencyStage::TRADE_CALLBACK: return "trade_callback";
+        case LatencyStage::WS_BROADCAST: return "ws_broadcast";
+        default: return "unknown";
+    }
+}
+
+// LatencyHistogram
+
+LatencyHistogram::LatencyHistogram() : counts_(new std::atomic<uint64_t>[BUCKETS]) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts_[i].store(0, std::memory_order_relaxed);
+}
+
+// Values below 2^SUB_BITS map to themselves; above, the top SUB_BITS bits
+// pick one of 2^(SUB_BITS-1) buckets within the value's power of two
+size_t LatencyHistogram::bucketFor(uint64_t ns) {
+    const uint64_t max_value = (uint64_t(1) << MAX_BITS) - 1;
+    if (ns > max_value) ns = max_value;
+    if (ns < (uint64_t(1) << SUB_BITS)) return static_cast<size_t>(ns);
+    
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+    unsigned shift = msb - SUB_BITS + 1;
+    return (static_cast<size_t>(shift) << (SUB_BITS - 1)) + static_cast<size_t>(ns >> shift);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < (size_t(1) << SUB_BITS)) return bucket;
+    
+    size_t shift = (bucket >> (SUB_BITS - 1)) - 1;
+    uint64_t sub = bucket - (shift << (SUB_BITS - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::mergeInto(Snapshot& out) const {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        out.counts[i] += counts_[i].load(std::memory_order_relaxed);
+    }
+    out.count += total_.load(std::memory_order_relaxed);
+    out.sum += sum_.load(std::memory_order_relaxed);
+    out.max = std::max(out.max, max_.load(std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    // Walk the buckets rather than trust count: a concurrent read can see a
+    // bucket bump before the matching total
+    uint64_t total = 0;
+    for (uint64_t c : counts) total += c;
+    if (total == 0) return 0;
+    
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+// LatencyMetrics
+
+static std::atomic<uint64_t> next_metrics_id{1};
+static std::atomic<size_t> next_thread_stripe{0};
+
+static size_t defaultStripes() {
+    size_t threads = std::thread::hardware_concurrency();
+    return std::min<size_t>(std::max<size_t>(threads, 1), 64);
+}
+
+LatencyMetrics::LatencyMetrics(size_t stripes)
+    : stripe_count_(stripes > 0 ? stripes : defaultStripes()),
+      id_(next_metrics_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+LatencyMetrics::~LatencyMetrics() = default;
+
+LatencyMetrics::Striped::Striped(size_t count)
+    : count(count), stripes(new std::atomic<LatencyHistogram*>[count]) {
+    for (size_t i = 0; i < count; ++i) stripes[i].store(nullptr, std::memory_order_relaxed);
+}
+
+LatencyMetrics::Striped::~Striped() {
+    for (size_t i = 0; i < count; ++i) delete stripes[i].load(std::memory_order_relaxed);
+}
+
+LatencyHistogram& LatencyMetrics::Striped::stripe(size_t index) {
+    LatencyHistogram* histogram = stripes[index].load(std::memory_order_acquire);
+    if (histogram) return *histogram;
+    
+    // Two threads sharing a stripe may race to create it; one copy wins
+    auto created = std::make_unique<LatencyHistogram>();
+    if (stripes[index].compare_exchange_strong(histogram, created.get(),
+                                               std::memory_order_acq_rel)) {
+        return *created.release();
+    }
+    return *histogram;
+}
+
+uint64_t LatencyMetrics::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+LatencyMetrics::Striped& LatencyMetrics::lookup(uint64_t key) {
+    struct Cache {
+        uint64_t owner = 0;
+        std::unordered_map<uint64_t, Striped*> entries;
+    };
+    thread_local Cache cache;
+    if (cache.owner != id_) {
+        cache.owner = id_;
+        cache.entries.clear();
+    }
+    auto it = cache.entries.find(key);
+    if (it != cache.entries.end()) return *it->second;
+    
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    auto& slot = registry_[key];
+    if (!slot) slot = std::make_unique<Striped>(stripe_count_);
+    cache.entries.emplace(key, slot.get());
+    return *slot;
+}
+
+void LatencyMetrics::record(LatencyStage stage, SymbolId symbol_id, uint8_t order_type, uint64_t ns) {
+    if (!enabled()) return;
+    thread_local size_t stripe = next_thread_stripe.fetch_add(1, std::memory_order_relaxed);
+    lookup(keyFor(stage, symbol_id, order_type)).stripe(stripe % stripe_count_).record(ns);
+}
+
+std::vector<LatencyMetrics::Series> LatencyMetrics::snapshot() const {
+    std::vector<std::pair<uint64_t, const Striped*>> keys;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        for (const auto& entry : registry_) keys.emplace_back(entry.first, entry.second.get());
+    }
+    std::sort(keys.begin(), keys.end());
+    
+    std::vector<Series> series;
+    series.reserve(keys.size());
+    for (const auto& [key, striped] : keys) {
+        Series s;
+        s.stage = static_cast<LatencyStage>(key >> 40);
+        s.order_type = static_cast<uint8_t>(key >> 32);
+        s.symbol_id = static_cast<SymbolId>(key);
+        s.stripes = 0;
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            const LatencyHistogram* histogram = striped->stripes[i].load(std::memory_order_acquire);
+            if (!histogram) continue;
+            histogram->mergeInto(s.histogram);
+            s.stripes++;
+        }
+        series.push_back(std::move(s));
+    }
+    return series;
+}
+
+} // namespace MatchingEngine
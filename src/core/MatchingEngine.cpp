@@ -1,106 +1,487 @@
 #include "core/MatchingEngine.hpp"
-#include <iostream>
-#include <sstream>
-#include <iomanip>
+#include "core/AsyncLogger.hpp"
 #include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <optional>
+#ifdef __linux__
+#include <pthread.h>
+#endif
 
 namespace MatchingEngine {
 
+namespace {
+// Cascade depth of the triggered stop this thread is executing; 0 outside a
+// drain. Per thread, so inline callers draining different symbols don't
+// stamp each other's triggers.
+thread_local uint32_t executing_depth = 0;
+}
+
 // MatchingEngineCore implementation (minimal, essential comments only)
-MatchingEngineCore::MatchingEngineCore()
-    : total_orders_processed_(0), total_trades_executed_(0), order_id_counter_(0) {}
+MatchingEngineCore::MatchingEngineCore(const EngineConfig& config)
+    : config_(config), clock_(config.clock_source), sharded_(config.shard_count > 0),
+      books_(new std::atomic<OrderBook*>[Config::MAX_SYMBOLS]),
+      terminal_orders_(config.terminal_retention_count, config.terminal_retention_age_ns),
+      total_orders_processed_(0), total_trades_executed_(0), order_id_counter_(1) {
+    for (size_t i = 0; i < Config::MAX_SYMBOLS; ++i) {
+        books_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    latency_.setEnabled(config.latency_metrics);
+    
+    size_t shard_count = sharded_ ? config.shard_count : 1;
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(sharded_ ? config.queue_capacity : 2));
+    }
+    if (sharded_) {
+        for (size_t i = 0; i < shard_count; ++i) {
+            shards_[i]->running.store(true, std::memory_order_release);
+            shards_[i]->thread = std::thread(&MatchingEngineCore::runShard, this, i);
+        }
+    }
+}
+
+MatchingEngineCore::~MatchingEngineCore() {
+    // Shards drain whatever is already queued before exiting
+    for (auto& shard : shards_) {
+        shard->running.store(false, std::memory_order_release);
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+OrderId MatchingEngineCore::submitOrder(OrderPtr order) {
+    if (!admitOrder(order, clock_.now())) return 0;
+    OrderId order_id = order->order_id;
+    
+    if (!sharded_) {
+        const SymbolId symbol_id = order->symbol_id;
+        executeOrder(*order);
+        drainInline(symbol_id);
+        return order_id;
+    }
+    
+    Completion completion;
+    Shard& shard = shardFor(order->symbol_id);
+    dispatch(shard, Command{Command::Kind::SUBMIT, std::move(order), &completion});
+    completion.wait();
+    return order_id;
+}
+
+OrderId MatchingEngineCore::submitOrderAsync(OrderPtr order) {
+    if (!admitOrder(order, clock_.now())) return 0;
+    OrderId order_id = order->order_id;
+    
+    if (!sharded_) {
+        const SymbolId symbol_id = order->symbol_id;
+        executeOrder(*order);
+        drainInline(symbol_id);
+        return order_id;
+    }
+    
+    Shard& shard = shardFor(order->symbol_id);
+    dispatch(shard, Command{Command::Kind::SUBMIT, std::move(order), nullptr});
+    return order_id;
+}
+
+bool MatchingEngineCore::cancelOrder(OrderId order_id) {
+    OrderPtr order;
+    {
+        std::lock_guard<OrdersMutex> lock(orders_mutex_);
+        auto it = live_orders_.find(order_id);
+        if (it == live_orders_.end()) return false;
+        order = it->second;
+    }
+    
+    if (!sharded_) {
+        bool cancelled = executeCancel(*order);
+        drainInline(Config::INVALID_SYMBOL);
+        return cancelled;
+    }
+    
+    Completion completion;
+    Shard& shard = shardFor(order->symbol_id);
+    dispatch(shard, Command{Command::Kind::CANCEL, std::move(order), &completion});
+    return completion.wait();
+}
+
+std::vector<OrderId> MatchingEngineCore::submitOrders(const std::vector<OrderPtr>& orders) {
+    std::vector<OrderId> ids(orders.size(), 0);
+    const Timestamp now = clock_.now();  // A batch is one event
+    
+    if (!sharded_) {
+        std::vector<Order*> admitted;
+        admitted.reserve(orders.size());
+        for (size_t i = 0; i < orders.size(); ++i) {
+            if (!admitOrder(orders[i], now)) continue;
+            ids[i] = orders[i]->order_id;
+            admitted.push_back(orders[i].get());
+        }
+        executeOrders(admitted);
+        drainInline(Config::INVALID_SYMBOL);
+        return ids;
+    }
+    
+    // One command per shard touched, then wait for all of them
+    std::vector<std::vector<OrderPtr>> batches(shards_.size());
+    for (size_t i = 0; i < orders.size(); ++i) {
+        if (!admitOrder(orders[i], now)) continue;
+        ids[i] = orders[i]->order_id;
+        batches[shardIndex(orders[i]->symbol_id)].push_back(orders[i]);
+    }
+    
+    std::unique_ptr<Completion[]> completions(new Completion[shards_.size()]);
+    std::vector<size_t> dispatched;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (batches[s].empty()) continue;
+        Command command{Command::Kind::SUBMIT_BATCH, nullptr, &completions[s]};
+        command.batch = std::move(batches[s]);
+        dispatch(*shards_[s], std::move(command));
+        dispatched.push_back(s);
+    }
+    for (size_t s : dispatched) {
+        completions[s].wait();
+    }
+    return ids;
+}
+
+std::vector<bool> MatchingEngineCore::cancelOrders(const std::vector<OrderId>& order_ids) {
+    std::vector<bool> cancelled(order_ids.size(), false);
+    
+    // Resolve every id under one directory lock
+    std::vector<std::pair<OrderPtr, size_t>> found;
+    found.reserve(order_ids.size());
+    {
+        std::lock_guard<OrdersMutex> lock(orders_mutex_);
+        for (size_t i = 0; i < order_ids.size(); ++i) {
+            auto it = live_orders_.find(order_ids[i]);
+            if (it != live_orders_.end()) found.emplace_back(it->second, i);
+        }
+    }
+    
+    if (!sharded_) {
+        std::vector<Order*> orders;
+        orders.reserve(found.size());
+        for (const auto& entry : found) orders.push_back(entry.first.get());
+        std::vector<uint8_t> results(orders.size(), 0);
+        executeCancels(orders, results.data());
+        drainInline(Config::INVALID_SYMBOL);
+        for (size_t k = 0; k < found.size(); ++k) {
+            cancelled[found[k].second] = results[k] != 0;
+        }
+        return cancelled;
+    }
+    
+    std::vector<std::vector<OrderPtr>> batches(shards_.size());
+    std::vector<std::vector<size_t>> positions(shards_.size());
+    for (auto& [order, position] : found) {
+        size_t s = shardIndex(order->symbol_id);
+        batches[s].push_back(std::move(order));
+        positions[s].push_back(position);
+    }
+    
+    std::unique_ptr<Completion[]> completions(new Completion[shards_.size()]);
+    std::vector<std::vector<uint8_t>> results(shards_.size());
+    std::vector<size_t> dispatched;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (batches[s].empty()) continue;
+        Command command{Command::Kind::CANCEL_BATCH, nullptr, &completions[s]};
+        command.batch = std::move(batches[s]);
+        command.results = &results[s];
+        dispatch(*shards_[s], std::move(command));
+        dispatched.push_back(s);
+    }
+    for (size_t s : dispatched) {
+        completions[s].wait();
+        for (size_t k = 0; k < positions[s].size(); ++k) {
+            cancelled[positions[s][k]] = results[s][k] != 0;
+        }
+    }
+    return cancelled;
+}
 
-std::string MatchingEngineCore::submitOrder(OrderPtr order) {
+// Assign an id, validate and register as live (caller's thread)
+bool MatchingEngineCore::admitOrder(const OrderPtr& order, Timestamp now) {
+    uint64_t started = latency_.start();
+    
     // Generate order ID if needed
-    if (order->order_id.empty()) {
+    if (order->order_id == 0) {
         order->order_id = generateOrderId();
     }
+    order->timestamp = now;
     
     // Validate
     std::string error;
-    if (!validateOrder(order, error)) {
+    if (!validateOrder(*order, error)) {
         order->status = OrderStatus::REJECTED;
-        return "";
+        latency_.recordSince(LatencyStage::VALIDATE, order->symbol_id, order->type, started);
+        return false;
     }
     
     // Store
     {
-        std::lock_guard<std::mutex> lock(orders_mutex_);
-        all_orders_[order->order_id] = order;
+        std::lock_guard<OrdersMutex> lock(orders_mutex_);
+        live_orders_[order->order_id] = order;
     }
-    
-    // Process
+    latency_.recordSince(LatencyStage::VALIDATE, order->symbol_id, order->type, started);
+    return true;
+}
+
+// Match an admitted order (owning shard's thread, or the caller when inline)
+void MatchingEngineCore::executeOrder(Order& order) {
+    // Internally orders travel as plain references
     processOrder(order);
     total_orders_processed_.fetch_add(1, std::memory_order_relaxed);
-    
-    return order->order_id;
 }
 
-bool MatchingEngineCore::cancelOrder(const OrderId& order_id) {
-    OrderPtr order;
+void MatchingEngineCore::executeOrders(std::vector<Order*>& orders) {
+    std::stable_sort(orders.begin(), orders.end(), [](const Order* a, const Order* b) {
+        return a->symbol_id < b->symbol_id;
+    });
+    
+    for (size_t i = 0; i < orders.size(); ) {
+        size_t end = i + 1;
+        while (end < orders.size() && orders[end]->symbol_id == orders[i]->symbol_id) end++;
+        processOrders(orders[i]->symbol_id, orders.data() + i, end - i);
+        i = end;
+    }
+    total_orders_processed_.fetch_add(orders.size(), std::memory_order_relaxed);
+}
+
+bool MatchingEngineCore::executeCancel(Order& order) {
+    std::pair<Order*, size_t> entry{&order, 0};
+    uint8_t result = 0;
+    cancelRun(order.symbol_id, &entry, 1, &result);
+    return result != 0;
+}
+
+void MatchingEngineCore::executeCancels(const std::vector<Order*>& orders, uint8_t* results) {
+    std::vector<std::pair<Order*, size_t>> entries;
+    entries.reserve(orders.size());
+    for (size_t i = 0; i < orders.size(); ++i) entries.emplace_back(orders[i], i);
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.first->symbol_id < b.first->symbol_id;
+    });
+    
+    for (size_t i = 0; i < entries.size(); ) {
+        SymbolId symbol_id = entries[i].first->symbol_id;
+        size_t end = i + 1;
+        while (end < entries.size() && entries[end].first->symbol_id == symbol_id) end++;
+        cancelRun(symbol_id, entries.data() + i, end - i, results);
+        i = end;
+    }
+}
+
+// Cancel orders of one symbol under a single book session; results[pos] is
+// set for each entry's position
+void MatchingEngineCore::cancelRun(SymbolId symbol_id, const std::pair<Order*, size_t>* entries,
+                                   size_t count, uint8_t* results) {
+    OrderBook* book = getOrderBook(symbol_id);
+    std::vector<LevelUpdate> updates;
     {
-        std::lock_guard<std::mutex> lock(orders_mutex_);
-        auto it = all_orders_.find(order_id);
-        if (it == all_orders_.end()) return false;
-        order = it->second;
+        std::optional<OrderBook::Session> session;
+        if (book) session.emplace(*book);
+        
+        for (size_t i = 0; i < count; ++i) {
+            Order& order = *entries[i].first;
+            bool cancelled = false;
+            
+            // Status and type are not read here: a trigger on another thread
+            // may be flipping them. Resting orders only change under the
+            // session we hold; anything else is decided under the trigger lock.
+            if (session) cancelled = session->cancelOrder(order.order_id);
+            if (!cancelled) {
+                cancelled = cancelPendingStop(shardFor(symbol_id), symbol_id, order);
+            }
+            results[entries[i].second] = cancelled ? 1 : 0;
+        }
+        if (session) session->takeLevelUpdates(updates);
     }
     
-    // If it's a pending stop order, cancel from stop order manager
-    if (order->status == OrderStatus::PENDING && order->isStopOrder()) {
-        return stop_order_manager_.cancelStopOrder(order_id);
+    for (size_t i = 0; i < count; ++i) {
+        if (results[entries[i].second]) {
+            retireOrder(*entries[i].first);
+        }
     }
-    
-    if (order->status != OrderStatus::ACTIVE && 
-        order->status != OrderStatus::PARTIAL_FILL) {
-        return false;
+    publishLevelUpdates(symbol_id, updates);
+}
+
+void MatchingEngineCore::dispatch(Shard& shard, Command&& command) {
+    // Full ring: back off until the shard catches up
+    while (!shard.queue.tryPush(std::move(command))) {
+        std::this_thread::yield();
     }
+}
+
+void MatchingEngineCore::runShard(size_t index) {
+    Shard& shard = *shards_[index];
+    
+#ifdef __linux__
+    if (config_.pin_threads) {
+        unsigned cpus = std::thread::hardware_concurrency();
+        if (cpus > 0) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(index % cpus, &cpuset);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        }
+    }
+#endif
+    
+    Command command;
+    unsigned idle = 0;
+    for (;;) {
+        if (shard.queue.tryPop(command)) {
+            idle = 0;
+            switch (command.kind) {
+                case Command::Kind::SUBMIT:
+                    executeOrder(*command.order);
+                    if (command.completion) command.completion->signal(true);
+                    break;
+                case Command::Kind::CANCEL:
+                    command.completion->signal(executeCancel(*command.order));
+                    break;
+                case Command::Kind::SUBMIT_BATCH:
+                case Command::Kind::CANCEL_BATCH: {
+                    std::vector<Order*> orders;
+                    orders.reserve(command.batch.size());
+                    for (const auto& order : command.batch) orders.push_back(order.get());
+                    if (command.kind == Command::Kind::SUBMIT_BATCH) {
+                        executeOrders(orders);
+                    } else {
+                        command.results->assign(orders.size(), 0);
+                        executeCancels(orders, command.results->data());
+                    }
+                    command.completion->signal(true);
+                    break;
+                }
+            }
+            command = Command();
+            continue;
+        }
+        
+        if (shard.queued_triggers.load(std::memory_order_relaxed) > 0) {
+            drainQueuedTriggers(shard);
+            idle = 0;
+            continue;
+        }
+        
+        if (!shard.running.load(std::memory_order_acquire)) break;
+        
+        // Idle: spin briefly, then yield, then sleep so idle shards stay cheap
+        if (++idle < 256) continue;
+        if (idle < 4096) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+OrderPtr MatchingEngineCore::getOrder(OrderId order_id) const {
+    std::lock_guard<OrdersMutex> lock(orders_mutex_);
+    auto it = live_orders_.find(order_id);
+    if (it != live_orders_.end()) return it->second;
+    
+    // Retired orders are served as detached copies
+    const auto* record = terminal_orders_.find(order_id, clock_.now());
+    return record ? std::make_shared<Order>(TerminalOrderStore::toOrder(*record)) : nullptr;
+}
+
+size_t MatchingEngineCore::getLiveOrderCount() const {
+    std::lock_guard<OrdersMutex> lock(orders_mutex_);
+    return live_orders_.size();
+}
+
+size_t MatchingEngineCore::getTerminalOrderCount() const {
+    std::lock_guard<OrdersMutex> lock(orders_mutex_);
+    return terminal_orders_.size();
+}
+
+// Done = no longer resting on a book and not waiting for a stop trigger
+bool MatchingEngineCore::isDone(const Order& order) const {
+    if (order.level) return false;
+    return !(order.status == OrderStatus::PENDING && order.isStopOrder());
+}
+
+// Retirement is stamped under the orders mutex, so the terminal store's ring
+// is filled in time order whichever thread retires
+void MatchingEngineCore::retireOrder(const Order& order) {
+    std::lock_guard<OrdersMutex> lock(orders_mutex_);
     
-    auto book = getOrderBook(order->symbol);
-    if (!book) return false;
+    terminal_orders_.insert(order, clock_.now());
     
-    return book->cancelOrder(order_id);
+    // Drop the engine's reference last; this may recycle the pooled slot
+    live_orders_.erase(order.order_id);
+}
+
+void MatchingEngineCore::retireFilledMakers(const std::vector<Trade>& trades) {
+    if (trades.empty()) return;
+    
+    std::lock_guard<OrdersMutex> lock(orders_mutex_);
+    const Timestamp now = clock_.now();
+    for (const auto& trade : trades) {
+        // Flagged under the book lock; the maker itself may be matched by
+        // another caller by now if it is still resting
+        if (!trade.maker_filled) continue;
+        auto it = live_orders_.find(trade.maker_order_id);
+        if (it == live_orders_.end()) continue;
+        
+        terminal_orders_.insert(*it->second, now);
+        live_orders_.erase(it);
+    }
 }
 
-OrderPtr MatchingEngineCore::getOrder(const OrderId& order_id) const {
-    std::lock_guard<std::mutex> lock(orders_mutex_);
-    auto it = all_orders_.find(order_id);
-    return (it != all_orders_.end()) ? it->second : nullptr;
+OrderBook* MatchingEngineCore::getOrderBook(SymbolId symbol_id) const {
+    if (!symbols_.contains(symbol_id)) return nullptr;
+    return books_[symbol_id].load(std::memory_order_acquire);
 }
 
-std::shared_ptr<OrderBook> MatchingEngineCore::getOrderBook(const Symbol& symbol) const {
-    std::lock_guard<std::mutex> lock(order_books_mutex_);
-    auto it = order_books_.find(symbol);
-    return (it != order_books_.end()) ? it->second : nullptr;
+SymbolId MatchingEngineCore::setSymbolSpec(const Symbol& symbol, const SymbolSpec& spec) {
+    SymbolId symbol_id = symbols_.intern(symbol);
+    if (symbol_id != Config::INVALID_SYMBOL) {
+        symbols_.setSpec(symbol_id, spec);
+    }
+    return symbol_id;
+}
+
+SymbolSpec MatchingEngineCore::getSymbolSpec(SymbolId symbol_id) const {
+    return symbols_.contains(symbol_id) ? symbols_.spec(symbol_id) : SymbolSpec{};
 }
 
 std::pair<std::optional<Price>, std::optional<Price>> 
-MatchingEngineCore::getBBO(const Symbol& symbol) const {
-    auto book = getOrderBook(symbol);
+MatchingEngineCore::getBBO(SymbolId symbol_id) const {
+    OrderBook* book = getOrderBook(symbol_id);
     return book ? book->getBBO() : std::make_pair(std::nullopt, std::nullopt);
 }
 
-bool MatchingEngineCore::validateOrder(const OrderPtr& order, std::string& error) const {
-    if (order->symbol.empty()) {
-        error = "Symbol required";
+TopOfBook MatchingEngineCore::getTopOfBook(SymbolId symbol_id) const {
+    OrderBook* book = getOrderBook(symbol_id);
+    return book ? book->getTopOfBook() : TopOfBook{};
+}
+
+bool MatchingEngineCore::validateOrder(const Order& order, std::string& error) const {
+    if (!symbols_.contains(order.symbol_id)) {
+        error = "Unknown symbol";
         return false;
     }
     
-    if (order->quantity <= 0.0) {
+    if (order.quantity <= 0) {
         error = "Quantity must be positive";
         return false;
     }
     
-    if (order->quantity < Config::MIN_ORDER_SIZE) {
+    if (order.quantity < Config::MIN_ORDER_LOTS) {
         error = "Quantity below minimum";
         return false;
     }
     
-    if ((order->type == OrderType::LIMIT) && order->price <= 0.0) {
+    if ((order.type == OrderType::LIMIT) && order.price <= 0) {
         error = "Limit orders require positive price";
         return false;
     }
     
-    if ((order->type == OrderType::MARKET) && order->price != 0.0) {
+    if ((order.type == OrderType::MARKET) && order.price != 0) {
         error = "Market orders should not specify price";
         return false;
     }
@@ -108,147 +489,180 @@ bool MatchingEngineCore::validateOrder(const OrderPtr& order, std::string& error
     return true;
 }
 
-void MatchingEngineCore::processOrder(OrderPtr order) {
-    // Check if this is a stop order
-    if (order->isStopOrder()) {
-        processStopOrder(order);
-        return;
+void MatchingEngineCore::processOrder(Order& order) {
+    Order* single = &order;
+    processOrders(order.symbol_id, &single, 1);
+}
+
+// Process orders for one symbol in sequence. Consecutive book orders share a
+// single book session; stop orders split the run so they only see trades
+// from orders submitted after them.
+void MatchingEngineCore::processOrders(SymbolId symbol_id, Order* const* orders, size_t count) {
+    size_t i = 0;
+    while (i < count) {
+        if (orders[i]->isStopOrder()) {
+            processStopOrder(*orders[i]);
+            i++;
+            continue;
+        }
+        
+        size_t end = i;
+        while (end < count && !orders[end]->isStopOrder()) end++;
+        matchRun(symbol_id, orders + i, end - i);
+        i = end;
     }
+}
+
+void MatchingEngineCore::matchRun(SymbolId symbol_id, Order* const* orders, size_t count) {
+    OrderBook& book = getOrCreateOrderBook(symbol_id);
+    std::vector<Trade> trades;
+    std::vector<LevelUpdate> updates;
+    std::vector<Order*> finished;
+    bool book_updated = false;
     
-    auto book = getOrCreateOrderBook(order->symbol);
+    {
+        OrderBook::Session session(book);
+        for (size_t i = 0; i < count; ++i) {
+            Order& order = *orders[i];
+            uint64_t started = latency_.start();
+            switch (order.type) {
+                case OrderType::MARKET:
+                    processMarketOrder(order, session, trades);
+                    break;
+                case OrderType::LIMIT:
+                    processLimitOrder(order, session, trades);
+                    book_updated = true;
+                    break;
+                case OrderType::IOC:
+                    processIOCOrder(order, session, trades);
+                    break;
+                case OrderType::FOK:
+                    processFOKOrder(order, session, trades);
+                    break;
+                default:
+                    ME_LOG_WARN("[MatchingEngine] Rejected order {}: unknown order type {}",
+                                order.order_id, order.type);
+                    order.status = OrderStatus::REJECTED;
+                    break;
+            }
+            latency_.recordSince(LatencyStage::MATCH, symbol_id, order.type, started);
+            // Decided under the book lock: once it is released, another
+            // caller may fill a resting order and retire it itself
+            if (isDone(order)) finished.push_back(&order);
+        }
+        session.takeLevelUpdates(updates);
+    }
     
-    switch (order->type) {
-        case OrderType::MARKET:
-            processMarketOrder(order, book);
-            break;
-        case OrderType::LIMIT:
-            processLimitOrder(order, book);
-            break;
-        case OrderType::IOC:
-            processIOCOrder(order, book);
-            break;
-        case OrderType::FOK:
-            processFOKOrder(order, book);
-            break;
-        default:
-            std::cerr << "Unknown order type" << std::endl;
-            order->status = OrderStatus::REJECTED;
-            break;
+    // Callbacks run once the book lock is released
+    publishTrades(trades);
+    publishLevelUpdates(symbol_id, updates);
+    if (book_updated && book_update_callback_) {
+        book_update_callback_(symbol_id);
     }
-}
-
-std::shared_ptr<OrderBook> MatchingEngineCore::getOrCreateOrderBook(const Symbol& symbol) {
-    std::lock_guard<std::mutex> lock(order_books_mutex_);
     
-    auto it = order_books_.find(symbol);
-    if (it == order_books_.end()) {
-        auto book = std::make_shared<OrderBook>(symbol);
-        order_books_[symbol] = book;
-        return book;
+    // One trigger check per run, over the range of prices it traded at
+    if (!trades.empty()) {
+        Price low = trades.front().price;
+        Price high = low;
+        for (const auto& trade : trades) {
+            low = std::min(low, trade.price);
+            high = std::max(high, trade.price);
+        }
+        checkAndTriggerStopOrders(symbol_id, low, high, trades.back().timestamp);
     }
+    drainTriggers(symbol_id);
     
-    return it->second;
-}
-
-std::string MatchingEngineCore::generateOrderId() {
-    uint64_t id = order_id_counter_.fetch_add(1, std::memory_order_relaxed);
-    std::ostringstream oss;
-    oss << "ORD" << std::setfill('0') << std::setw(12) << id;
-    return oss.str();
+    for (Order* order : finished) {
+        retireOrder(*order);
+    }
 }
 
-void MatchingEngineCore::processMarketOrder(OrderPtr order, std::shared_ptr<OrderBook> book) {
-    // Market orders match against all available liquidity at any price
-    auto trades = book->matchOrder(order);
+void MatchingEngineCore::publishTrades(const std::vector<Trade>& trades) {
+    retireFilledMakers(trades);
     
-    // Publish trades
     if (trade_callback_) {
         for (const auto& trade : trades) {
+            uint64_t started = latency_.start();
             trade_callback_(trade);
+            latency_.recordSince(LatencyStage::TRADE_CALLBACK, trade.symbol_id,
+                                 LatencyMetrics::NO_ORDER_TYPE, started);
             total_trades_executed_.fetch_add(1, std::memory_order_relaxed);
-            
-            // Check if any stop orders should be triggered by this trade
-            checkAndTriggerStopOrders(order->symbol, trade.price);
         }
     }
-    
-    // Set final status (market orders NEVER rest on book)
-    if (order->isFullyFilled()) {
-        order->status = OrderStatus::FILLED;
-    } else if (order->filled_quantity > 0.0) {
-        order->status = OrderStatus::PARTIAL_FILL;  // Got partial fill, rest cancelled
-    } else {
-        order->status = OrderStatus::CANCELLED;  // No liquidity available (rare)
+}
+
+void MatchingEngineCore::publishLevelUpdates(SymbolId symbol_id,
+                                             const std::vector<LevelUpdate>& updates) {
+    if (!updates.empty() && level_update_callback_) {
+        level_update_callback_(symbol_id, updates);
     }
 }
 
-void MatchingEngineCore::processLimitOrder(OrderPtr order, std::shared_ptr<OrderBook> book) {
-    // Add order to book first to show it in market data
-    book->addOrder(order);
-    order->status = OrderStatus::ACTIVE;
+OrderBook& MatchingEngineCore::getOrCreateOrderBook(SymbolId symbol_id) {
+    if (OrderBook* book = books_[symbol_id].load(std::memory_order_acquire)) {
+        return *book;
+    }
     
-    // Publish market data to show the order on the book  
-    if (book_update_callback_) {
-        book_update_callback_(order->symbol);
+    std::lock_guard<OrderBooksMutex> lock(order_books_mutex_);
+    if (OrderBook* book = books_[symbol_id].load(std::memory_order_relaxed)) {
+        return *book;
     }
     
-    // Now match the order against the OPPOSITE side
-    // (matchOrder only looks at opposite side, so our order won't match itself)
-    auto trades = book->matchOrder(order);
+    book_storage_.push_back(std::make_unique<OrderBook>(symbol_id, symbols_.spec(symbol_id)));
+    OrderBook* book = book_storage_.back().get();
+    book->setRecordLevelUpdates(static_cast<bool>(level_update_callback_));
+    books_[symbol_id].store(book, std::memory_order_release);
+    return *book;
+}
+
+OrderId MatchingEngineCore::generateOrderId() {
+    return order_id_counter_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MatchingEngineCore::processMarketOrder(Order& order, OrderBook::Session& book,
+                                            std::vector<Trade>& trades) {
+    // Market orders match against all available liquidity at any price
+    book.matchOrder(order, trades);
     
-    // Publish trades
-    if (trade_callback_) {
-        for (const auto& trade : trades) {
-            trade_callback_(trade);
-            total_trades_executed_.fetch_add(1, std::memory_order_relaxed);
-            
-            // Check stop orders
-            checkAndTriggerStopOrders(order->symbol, trade.price);
-        }
+    // Set final status (market orders NEVER rest on book)
+    if (order.isFullyFilled()) {
+        order.status = OrderStatus::FILLED;
+    } else if (order.filled_quantity > 0) {
+        order.status = OrderStatus::PARTIAL_FILL;  // Got partial fill, rest cancelled
+    } else {
+        order.status = OrderStatus::CANCELLED;  // No liquidity available (rare)
     }
-    
-    // If order was fully filled, remove it from the book
-    if (order->isFullyFilled()) {
-        book->cancelOrder(order->order_id);
-        order->status = OrderStatus::FILLED;
-        // No need to publish - trade already published
-        // Book state hasn't changed (order matched with opposite side)
-    } else if (order->filled_quantity > 0.0) {
-        order->status = OrderStatus::PARTIAL_FILL;
-        // Order still on book with reduced quantity - publish update
-        if (book_update_callback_) {
-            book_update_callback_(order->symbol);
-        }
+}
+
+void MatchingEngineCore::processLimitOrder(Order& order, OrderBook::Session& book,
+                                           std::vector<Trade>& trades) {
+    // Match against the opposite side, then rest any remainder - one book
+    // operation, so observers never see the order crossing the book
+    book.matchAndRest(order, trades);
+    
+    if (order.isFullyFilled()) {
+        order.status = OrderStatus::FILLED;  // Never rested
+    } else if (order.filled_quantity > 0) {
+        order.status = OrderStatus::PARTIAL_FILL;  // Remainder resting
     }
-    // If no fill, status remains ACTIVE (already on book, no need to publish again)
+    // If no fill, status is ACTIVE (resting untouched)
 }
 
-void MatchingEngineCore::processIOCOrder(OrderPtr order, std::shared_ptr<OrderBook> book) {
+void MatchingEngineCore::processIOCOrder(Order& order, OrderBook::Session& book,
+                                         std::vector<Trade>& trades) {
     // IOC (Immediate-Or-Cancel): Match immediately, never rest on book
     // DO NOT add order to book - match directly against opposite side
-    
-    auto trades = book->matchOrder(order);
-    
-    // Publish trades
-    if (trade_callback_) {
-        for (const auto& trade : trades) {
-            trade_callback_(trade);
-            total_trades_executed_.fetch_add(1, std::memory_order_relaxed);
-            
-            // Check stop orders
-            checkAndTriggerStopOrders(order->symbol, trade.price);
-        }
-    }
+    book.matchOrder(order, trades);
     
     // Set status - remainder is ALWAYS cancelled
-    if (order->isFullyFilled()) {
-        order->status = OrderStatus::FILLED;
+    if (order.isFullyFilled()) {
+        order.status = OrderStatus::FILLED;
     } else {
         // Any remainder is cancelled (this is the IOC behavior)
-        if (order->filled_quantity > 0.0) {
-            order->status = OrderStatus::PARTIAL_FILL;  // Then cancelled
+        if (order.filled_quantity > 0) {
+            order.status = OrderStatus::PARTIAL_FILL;  // Then cancelled
         } else {
-            order->status = OrderStatus::CANCELLED;  // Nothing filled
+            order.status = OrderStatus::CANCELLED;  // Nothing filled
         }
     }
     
@@ -256,39 +670,17 @@ void MatchingEngineCore::processIOCOrder(OrderPtr order, std::shared_ptr<OrderBo
     // Order was never added, so nothing to remove
 }
 
-void MatchingEngineCore::processFOKOrder(OrderPtr order, std::shared_ptr<OrderBook> book) {
+void MatchingEngineCore::processFOKOrder(Order& order, OrderBook::Session& book,
+                                         std::vector<Trade>& trades) {
     // FOK (Fill-Or-Kill): All-or-nothing execution
     // Must fill ENTIRE order immediately or reject completely
     
-    // Step 1: Check if can fill completely at limit price or better
-    if (!book->canFillFOK(order)) {
-        order->status = OrderStatus::CANCELLED;
-        // NO trades executed - order is killed entirely
-        return;
-    }
-    
-    // Step 2: Fill completely (we verified it's possible)
-    auto trades = book->matchOrder(order);
-    
-    // Step 3: Publish trades
-    if (trade_callback_) {
-        for (const auto& trade : trades) {
-            trade_callback_(trade);
-            total_trades_executed_.fetch_add(1, std::memory_order_relaxed);
-            
-            // Check stop orders
-            checkAndTriggerStopOrders(order->symbol, trade.price);
-        }
-    }
-    
-    // Step 4: Verify fully filled (should always be true if canFillFOK worked)
-    if (order->isFullyFilled()) {
-        order->status = OrderStatus::FILLED;
+    // Check and fill under the session's lock: either the whole order
+    // fills at its limit or better, or no trades are executed
+    if (book.fillOrKill(order, trades)) {
+        order.status = OrderStatus::FILLED;
     } else {
-        // This should NEVER happen if canFillFOK() is correct
-        // But handle defensively - cancel the order
-        order->status = OrderStatus::CANCELLED;
-        // In production, this would be logged as an error
+        order.status = OrderStatus::CANCELLED;
     }
     
     // FOK NEVER rests on book - it's either filled or killed
@@ -298,41 +690,185 @@ void MatchingEngineCore::processFOKOrder(OrderPtr order, std::shared_ptr<OrderBo
 // STOP ORDER PROCESSING (BONUS FEATURE)
 // ============================================================================
 
-void MatchingEngineCore::processStopOrder(OrderPtr order) {
+void MatchingEngineCore::processStopOrder(Order& order) {
     // Validate stop order has stop_price
-    if (order->stop_price <= 0.0) {
-        std::cerr << "Stop order requires positive stop_price" << std::endl;
-        order->status = OrderStatus::REJECTED;
+    if (order.stop_price <= 0) {
+        ME_LOG_WARN("[MatchingEngine] Rejected stop order {}: stop_price must be positive",
+                    order.order_id);
+        order.status = OrderStatus::REJECTED;
+        retireOrder(order);
         return;
     }
     
     // For STOP_LIMIT, also validate limit price
-    if (order->type == OrderType::STOP_LIMIT && order->price <= 0.0) {
-        std::cerr << "Stop-limit order requires positive limit price" << std::endl;
-        order->status = OrderStatus::REJECTED;
+    if (order.type == OrderType::STOP_LIMIT && order.price <= 0) {
+        ME_LOG_WARN("[MatchingEngine] Rejected stop-limit order {}: limit price must be positive",
+                    order.order_id);
+        order.status = OrderStatus::REJECTED;
+        retireOrder(order);
         return;
     }
     
-    // Add to stop order manager
-    stop_order_manager_.addStopOrder(order);
-    order->status = OrderStatus::PENDING;  // Waiting for trigger
+    // Marked PENDING under the manager's lock; not touched after, since
+    // another caller's trade may trigger it straight away
+    shardFor(order.symbol_id).stops.addStopOrder(order);
     
-    std::cout << "[MatchingEngine] Stop order " << order->order_id 
-              << " added with stop price " << order->stop_price << std::endl;
+    ME_LOG_DEBUG("[MatchingEngine] Stop order {} added with stop price {}",
+                 order.order_id, order.stop_price);
 }
 
-void MatchingEngineCore::checkAndTriggerStopOrders(const Symbol& symbol, Price last_trade_price) {
+void MatchingEngineCore::checkAndTriggerStopOrders(SymbolId symbol_id, Price low, Price high,
+                                                   Timestamp event_time) {
+    Shard& shard = shardFor(symbol_id);
+    
+    // Held from the manager to the queue, so a cancel sees the stop in one
+    // place or the other
+    std::lock_guard<TriggerMutex> trigger_lock(shard.trigger_mutex);
+    
     // Check if any stop orders should be triggered
-    auto triggered_orders = stop_order_manager_.checkTriggers(symbol, last_trade_price);
+    uint64_t started = latency_.start();
+    auto triggered_orders = shard.stops.checkTriggers(symbol_id, low, high);
+    latency_.recordSince(LatencyStage::STOP_TRIGGER, symbol_id, LatencyMetrics::NO_ORDER_TYPE, started);
+    if (triggered_orders.empty()) return;
+    
+    // Hold the slots while queued: a triggered order may fill as a maker and
+    // retire before its own processing unwinds
+    std::vector<OrderPtr> orders;
+    orders.reserve(triggered_orders.size());
+    {
+        std::lock_guard<OrdersMutex> lock(orders_mutex_);
+        for (Order* triggered : triggered_orders) {
+            triggered->timestamp = event_time;  // Its fills belong to the triggering event
+            auto it = live_orders_.find(triggered->order_id);
+            if (it != live_orders_.end()) orders.push_back(it->second);
+        }
+    }
+    
+    TriggerQueue& queue = shard.triggers[symbol_id];
+    for (auto& order : orders) {
+        queue.pending.emplace_back(std::move(order), executing_depth + 1);
+    }
+    shard.queued_triggers.fetch_add(orders.size(), std::memory_order_relaxed);
+}
+
+// Run the symbol's queued stops in FIFO order, up to the cascade budget.
+// Stops executed here only queue what they trigger; the outermost drain
+// picks that up, so a cascade never recurses.
+void MatchingEngineCore::drainTriggers(SymbolId symbol_id) {
+    Shard& shard = shardFor(symbol_id);
+    if (shard.queued_triggers.load(std::memory_order_relaxed) == 0) return;
+    
+    TriggerQueue* queue;
+    {
+        std::lock_guard<TriggerMutex> lock(shard.trigger_mutex);
+        auto it = shard.triggers.find(symbol_id);
+        if (it == shard.triggers.end() || it->second.draining || it->second.pending.empty()) {
+            return;
+        }
+        queue = &it->second;
+        queue->draining = true;
+    }
     
-    // Process each triggered order
-    for (auto& order : triggered_orders) {
-        std::cout << "[MatchingEngine] Processing triggered stop order " << order->order_id << std::endl;
+    const size_t budget = config_.stop_cascade_budget;
+    size_t executed = 0;
+    uint32_t max_depth = 0;
+    uint32_t depth = 0;
+    bool exhausted = false;
+    for (;;) {
+        OrderPtr order;
+        {
+            std::lock_guard<TriggerMutex> lock(shard.trigger_mutex);
+            if (queue->pending.empty() || (budget > 0 && executed == budget)) {
+                exhausted = !queue->pending.empty();
+                queue->draining = false;
+                break;
+            }
+            order = std::move(queue->pending.front().first);
+            depth = queue->pending.front().second;
+            queue->pending.pop_front();
+        }
+        max_depth = std::max(max_depth, depth);
+        shard.queued_triggers.fetch_sub(1, std::memory_order_relaxed);
+        
+        ME_LOG_DEBUG("[MatchingEngine] Processing triggered stop order {}", order->order_id);
         
         // Stop order has been converted to MARKET or LIMIT
         // Process it normally
-        processOrder(order);
+        const uint32_t outer_depth = executing_depth;  // Nonzero if nested in another symbol's drain
+        executing_depth = depth;
+        processOrder(*order);
+        executing_depth = outer_depth;
+        executed++;
+    }
+    
+    if (executed > 0) {
+        stop_triggers_executed_.fetch_add(executed, std::memory_order_relaxed);
+        stop_cascades_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t seen = stop_cascade_max_depth_.load(std::memory_order_relaxed);
+        while (max_depth > seen &&
+               !stop_cascade_max_depth_.compare_exchange_weak(seen, max_depth,
+                                                              std::memory_order_relaxed)) {}
+    }
+    if (exhausted) {
+        stop_budget_exhausted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Shard idle work: finish cascades a budget cut short. `skip` has already
+// had its budget for the current event.
+void MatchingEngineCore::drainQueuedTriggers(Shard& shard, SymbolId skip) {
+    std::vector<SymbolId> symbols;
+    {
+        std::lock_guard<TriggerMutex> lock(shard.trigger_mutex);
+        for (const auto& [symbol_id, queue] : shard.triggers) {
+            if (symbol_id != skip && !queue.pending.empty()) symbols.push_back(symbol_id);
+        }
+    }
+    for (SymbolId symbol_id : symbols) {
+        drainTriggers(symbol_id);
+    }
+}
+
+// Inline mode has no idle loop: every call gives each cut-short cascade
+// another budget, so a symbol that stops trading still finishes its stops
+void MatchingEngineCore::drainInline(SymbolId skip) {
+    Shard& shard = *shards_.front();
+    if (shard.queued_triggers.load(std::memory_order_relaxed) == 0) return;
+    drainQueuedTriggers(shard, skip);
+}
+
+// Cancel a stop that is not resting in the book: still waiting in the
+// manager, or triggered but queued behind a cascade the budget cut short.
+// A stop already popped for execution is not cancellable.
+bool MatchingEngineCore::cancelPendingStop(Shard& shard, SymbolId symbol_id, Order& order) {
+    {
+        std::lock_guard<TriggerMutex> lock(shard.trigger_mutex);
+        if (shard.stops.cancelStopOrder(order.order_id)) return true;
+        
+        auto it = shard.triggers.find(symbol_id);
+        if (it == shard.triggers.end()) return false;
+        auto& pending = it->second.pending;
+        auto entry = std::find_if(pending.begin(), pending.end(),
+                                  [&](const auto& queued) { return queued.first.get() == &order; });
+        if (entry == pending.end()) return false;  // Already popped for execution
+        pending.erase(entry);
+        order.status = OrderStatus::CANCELLED;
+    }
+    shard.queued_triggers.fetch_sub(1, std::memory_order_relaxed);
+    ME_LOG_DEBUG("[MatchingEngine] Cancelled queued triggered stop {}", order.order_id);
+    return true;
+}
+
+StopCascadeStats MatchingEngineCore::getStopCascadeStats() const {
+    StopCascadeStats stats;
+    stats.triggered = stop_triggers_executed_.load(std::memory_order_relaxed);
+    stats.cascades = stop_cascades_.load(std::memory_order_relaxed);
+    stats.max_depth = stop_cascade_max_depth_.load(std::memory_order_relaxed);
+    stats.budget_exhausted = stop_budget_exhausted_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        stats.queued += shard->queued_triggers.load(std::memory_order_relaxed);
     }
+    return stats;
 }
 
 } // namespace MatchingEngine
@@ -9,7 +9,7 @@ std::string Order::toString() const {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(8);
     oss << "Order{id=" << order_id 
-        << ", symbol=" << symbol
+        << ", symbol=" << symbol_id
         << ", type=" << orderTypeToString(type)
         << ", side=" << orderSideToString(side)
         << ", price=" << price
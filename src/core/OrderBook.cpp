@@ -1,171 +1,145 @@
 #include "core/OrderBook.hpp"
 #include "core/FeeConfig.hpp"
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
 
 namespace MatchingEngine {
 
 // OrderBook implementation (minimal, essential comments only)
 
-OrderBook::OrderBook(const Symbol& symbol)
-    : symbol_(symbol), sequence_counter_(0), trade_id_counter_(0) {}
+OrderBook::OrderBook(SymbolId symbol_id, const SymbolSpec& spec)
+    : symbol_id_(symbol_id), spec_(spec),
+      bids_(spec.ladder_ticks), asks_(spec.ladder_ticks),
+      sequence_counter_(0), trade_id_counter_(0) {}
 
-void OrderBook::addOrder(OrderPtr order) {
-    std::lock_guard<std::mutex> lock(book_mutex_);
-    
-    order->sequence = sequence_counter_.fetch_add(1, std::memory_order_relaxed);
+void OrderBook::addOrder(Order& order) {
+    Session(*this).addOrder(order);
+}
+
+void OrderBook::restOrder(Order& order) {
+    order.sequence = sequence_counter_.fetch_add(1, std::memory_order_relaxed);
     
-    if (order->side == OrderSide::BUY) {
-        auto& level = bids_[order->price];
-        level.price = order->price;
-        level.addOrder(order);
-    } else {
-        auto& level = asks_[order->price];
-        level.price = order->price;
-        level.addOrder(order);
-    }
+    PriceLevel& level = (order.side == OrderSide::BUY) ? bids_.getOrCreate(order.price)
+                                                        : asks_.getOrCreate(order.price);
+    bool created = level.isEmpty();
+    level.addOrder(&order);
+    noteLevelChange(order.side, order.price, level.total_quantity, created);
     
-    order_map_[order->order_id] = order;
-    order->status = OrderStatus::ACTIVE;
+    order_map_[order.order_id] = &order;
+    order.status = (order.filled_quantity > 0) ? OrderStatus::PARTIAL_FILL : OrderStatus::ACTIVE;
     
-    updateBBO();
+    ME_DEBUG_CHECK(order.level->checkConsistency());
 }
 
-bool OrderBook::cancelOrder(const OrderId& order_id) {
-    std::lock_guard<std::mutex> lock(book_mutex_);
-    
+bool OrderBook::cancelOrder(OrderId order_id) {
+    return Session(*this).cancelOrder(order_id);
+}
+
+bool OrderBook::removeOrder(OrderId order_id) {
     auto it = order_map_.find(order_id);
     if (it == order_map_.end()) return false;
     
-    OrderPtr order = it->second;
+    Order* order = it->second;
     
-    if (order->side == OrderSide::BUY) {
-        auto level_it = bids_.find(order->price);
-        if (level_it == bids_.end()) return false;
-        
-        PriceLevel& level = level_it->second;
-        if (!level.removeOrder(order_id)) return false;
-        
-        if (level.isEmpty()) {
-            bids_.erase(level_it);
-        }
-    } else {
-        auto level_it = asks_.find(order->price);
-        if (level_it == asks_.end()) return false;
-        
-        PriceLevel& level = level_it->second;
-        if (!level.removeOrder(order_id)) return false;
-        
-        if (level.isEmpty()) {
-            asks_.erase(level_it);
+    // O(1) unlink through the order's own level handle
+    PriceLevel* level = order->level;
+    if (!level || !level->removeOrder(order)) return false;
+    ME_DEBUG_CHECK(level->checkConsistency());
+    
+    noteLevelChange(order->side, order->price, level->total_quantity, false);
+    if (level->isEmpty()) {
+        if (order->side == OrderSide::BUY) {
+            bids_.erase(order->price);
+        } else {
+            asks_.erase(order->price);
         }
     }
     
     order_map_.erase(it);
     order->status = OrderStatus::CANCELLED;
-    updateBBO();
-    
     return true;
 }
 
-std::vector<Trade> OrderBook::matchOrder(OrderPtr order) {
-    std::lock_guard<std::mutex> lock(book_mutex_);
-    
+std::vector<Trade> OrderBook::matchOrder(Order& order) {
     std::vector<Trade> trades;
-    
-    if (order->side == OrderSide::BUY) {
-        matchAgainstBook(order, asks_, trades);
-    } else {
-        matchAgainstBook(order, bids_, trades);
-    }
-    
+    Session(*this).matchOrder(order, trades);
     return trades;
 }
 
-void OrderBook::matchAgainstBook(
-    OrderPtr taker,
-    std::map<Price, PriceLevel, std::less<Price>>& opposite_book,
-    std::vector<Trade>& trades) {
-    
-    // Buy order matching against asks (ascending price)
-    while (!taker->isFullyFilled() && !opposite_book.empty()) {
-        auto& [price, level] = *opposite_book.begin();
-        
-        // Check if can match at this price (NO TRADE-THROUGH)
-        if (!taker->canMatchAtPrice(price)) {
-            break;
-        }
-        
-        matchAtPriceLevel(taker, level, trades);
-        
-        if (level.isEmpty()) {
-            opposite_book.erase(opposite_book.begin());
-        }
+std::vector<Trade> OrderBook::matchAndRest(Order& order) {
+    // Only the remainder ever touches our own side, so the book is never crossed
+    std::vector<Trade> trades;
+    Session(*this).matchAndRest(order, trades);
+    return trades;
+}
+
+void OrderBook::matchInto(Order& order, std::vector<Trade>& trades) {
+    if (order.side == OrderSide::BUY) {
+        matchAgainstBook(order, asks_, trades);
+    } else {
+        matchAgainstBook(order, bids_, trades);
     }
-    
-    updateBBO();
 }
 
-void OrderBook::matchAgainstBook(
-    OrderPtr taker,
-    std::map<Price, PriceLevel, std::greater<Price>>& opposite_book,
-    std::vector<Trade>& trades) {
+template <typename Ladder>
+void OrderBook::matchAgainstBook(Order& taker, Ladder& opposite_book, std::vector<Trade>& trades) {
+    const OrderSide maker_side = (taker.side == OrderSide::BUY) ? OrderSide::SELL : OrderSide::BUY;
     
-    // Sell order matching against bids (descending price)
-    while (!taker->isFullyFilled() && !opposite_book.empty()) {
-        auto& [price, level] = *opposite_book.begin();
+    // Walk the opposite side best-first (asks ascending, bids descending)
+    while (!taker.isFullyFilled() && !opposite_book.empty()) {
+        PriceLevel& level = *opposite_book.best();
         
         // Check if can match at this price (NO TRADE-THROUGH)
-        if (!taker->canMatchAtPrice(price)) {
+        if (!taker.canMatchAtPrice(level.price)) {
             break;
         }
         
         matchAtPriceLevel(taker, level, trades);
+        noteLevelChange(maker_side, level.price, level.total_quantity, false);
         
         if (level.isEmpty()) {
-            opposite_book.erase(opposite_book.begin());
+            opposite_book.erase(level.price);
         }
     }
-    
-    updateBBO();
 }
 
-void OrderBook::matchAtPriceLevel(OrderPtr taker, PriceLevel& level, std::vector<Trade>& trades) {
+void OrderBook::matchAtPriceLevel(Order& taker, PriceLevel& level, std::vector<Trade>& trades) {
     // Match against orders at this level in FIFO order
-    while (!taker->isFullyFilled() && !level.isEmpty()) {
-        OrderPtr maker = level.frontOrder();
+    while (!taker.isFullyFilled() && !level.isEmpty()) {
+        Order* maker = level.frontOrder();
         
         // Calculate fill quantity
         Quantity fill_qty = std::min(
-            taker->remainingQuantity(),
+            taker.remainingQuantity(),
             maker->remainingQuantity()
         );
         
         // Create trade at maker's price (maker was here first)
-        Trade trade = createTrade(taker, maker, level.price, fill_qty);
+        Trade trade = createTrade(taker, *maker, level.price, fill_qty);
         trades.push_back(trade);
         
-        // Update filled quantities
-        taker->fill(fill_qty, level.price);
+        // Update filled quantities and level aggregates
+        taker.fill(fill_qty, level.price);
         maker->fill(fill_qty, level.price);
+        level.applyFill(fill_qty);
         
         // Remove fully filled maker
         if (maker->isFullyFilled()) {
+            trades.back().maker_filled = true;
             level.removeFrontOrder();
+            order_map_.erase(maker->order_id);
         }
-        
-        level.updateQuantity();
     }
+    
+    ME_DEBUG_CHECK(level.checkConsistency());
 }
 
-Trade OrderBook::createTrade(OrderPtr taker, OrderPtr maker, Price price, Quantity quantity) {
-    std::string trade_id = generateTradeId();
-    std::string aggressor = (taker->side == OrderSide::BUY) ? "buy" : "sell";
+Trade OrderBook::createTrade(const Order& taker, const Order& maker, Price price, Quantity quantity) {
+    TradeId trade_id = generateTradeId();
+    std::string aggressor = (taker.side == OrderSide::BUY) ? "buy" : "sell";
     
-    // Create trade
-    Trade trade(trade_id, symbol_, price, quantity,
-                maker->order_id, taker->order_id, aggressor);
+    // Every fill of one taker carries the time its event was stamped
+    Trade trade(trade_id, symbol_id_, price, quantity,
+                maker.order_id, taker.order_id, aggressor, taker.timestamp);
     
     // Calculate fees
     // Maker was already on the book (adds liquidity)
@@ -178,84 +152,212 @@ Trade OrderBook::createTrade(OrderPtr taker, OrderPtr maker, Price price, Quanti
     return trade;
 }
 
-std::string OrderBook::generateTradeId() {
-    std::ostringstream oss;
-    oss << symbol_ << "_" << std::setfill('0') << std::setw(10) << (trade_id_counter_.fetch_add(1, std::memory_order_relaxed));
-    return oss.str();
+TradeId OrderBook::generateTradeId() {
+    return trade_id_counter_.fetch_add(1, std::memory_order_relaxed);
 }
 
-bool OrderBook::canFillFOK(const OrderPtr& order) const {
-    Quantity remaining = order->quantity;
-    
-    if (order->side == OrderSide::BUY) {
-        for (const auto& [price, level] : asks_) {
-            if (!order->canMatchAtPrice(price)) break;
-            remaining -= level.total_quantity;
-            if (remaining <= Config::EPSILON) return true;
-        }
-    } else {
-        for (const auto& [price, level] : bids_) {
-            if (!order->canMatchAtPrice(price)) break;
-            remaining -= level.total_quantity;
-            if (remaining <= Config::EPSILON) return true;
-        }
+// One best-first pass over level aggregates, stopping at the first level
+// that is out of price or once enough quantity has been seen
+template <typename Ladder>
+bool OrderBook::canFillFrom(const Ladder& book, const Order& order) const {
+    Quantity remaining = order.remainingQuantity();
+    book.forEach([&](const PriceLevel& level) {
+        if (!order.canMatchAtPrice(level.price)) return false;
+        remaining -= level.total_quantity;
+        return remaining > 0;
+    });
+    return remaining <= 0;
+}
+
+bool OrderBook::fillableQuantityReached(const Order& order) const {
+    if (order.side == OrderSide::BUY) {
+        return canFillFrom(asks_, order);
     }
-    
-    return false;
+    return canFillFrom(bids_, order);
+}
+
+bool OrderBook::canFillFOK(const Order& order) const {
+    std::lock_guard<Mutex> lock(book_mutex_);
+    return fillableQuantityReached(order);
+}
+
+bool OrderBook::fillOrKill(Order& order, std::vector<Trade>& trades) {
+    return Session(*this).fillOrKill(order, trades);
+}
+
+bool OrderBook::fillOrKillLocked(Order& order, std::vector<Trade>& trades) {
+    // Nothing can consume liquidity between the check and the fill, so a
+    // passing check always fills completely
+    if (!fillableQuantityReached(order)) return false;
+    matchInto(order, trades);
+    ME_DEBUG_CHECK(order.isFullyFilled());
+    return true;
 }
 
 std::pair<std::optional<Price>, std::optional<Price>> OrderBook::getBBO() const {
-    return {best_bid_, best_ask_};
+    TopOfBook top = top_.load();
+    return {top.hasBid() ? std::optional<Price>(top.bid_price) : std::nullopt,
+            top.hasAsk() ? std::optional<Price>(top.ask_price) : std::nullopt};
 }
 
 void OrderBook::updateBBO() {
-    best_bid_ = bids_.empty() ? std::nullopt : std::optional<Price>(bids_.begin()->first);
-    best_ask_ = asks_.empty() ? std::nullopt : std::optional<Price>(asks_.begin()->first);
+    // One version per change, shared by the top of book, the depth image and
+    // the level updates, so a delta's sequence lines up with any snapshot
+    if (!changed_) return;
+    changed_ = false;
+    
+    TopOfBook top;
+    if (const PriceLevel* bid = bids_.best()) {
+        top.bid_price = bid->price;
+        top.bid_quantity = bid->total_quantity;
+    }
+    if (const PriceLevel* ask = asks_.best()) {
+        top.ask_price = ask->price;
+        top.ask_quantity = ask->total_quantity;
+    }
+    top.sequence = ++book_version_;
+    top_.store(top);
+    publishDepth();
 }
 
-std::vector<std::pair<Price, Quantity>> OrderBook::getBids(int depth) const {
-    std::vector<std::pair<Price, Quantity>> result;
-    result.reserve(depth);
+// Record one level's change for the delta feed and keep the depth image in
+// step with it. Every change, even below the image, advances the version. Quantity updates, new levels and removals that leave room
+// are applied in place; removing a level from a full image needs the next
+// level down, so that side is re-walked at publish time.
+void OrderBook::noteLevelChange(OrderSide side, Price price, Quantity quantity, bool created) {
+    changed_ = true;
+    if (record_level_updates_) {
+        level_updates_.push_back(LevelUpdate{side, price, quantity, book_version_ + 1});
+    }
+    
+    const bool buy = (side == OrderSide::BUY);
+    DepthImage::Level* levels = buy ? depth_working_.bids : depth_working_.asks;
+    uint32_t& count = buy ? depth_working_.bid_count : depth_working_.ask_count;
+    bool& rebuild = buy ? rebuild_bids_ : rebuild_asks_;
+    if (rebuild) return;
+    
+    // Position of the first level not better than price
+    auto better = [buy](Price a, Price b) { return buy ? a > b : a < b; };
+    uint32_t pos = 0;
+    while (pos < count && better(levels[pos].price, price)) pos++;
+    
+    if (pos == Config::DEPTH_LEVELS) return;  // Below the image
+    bool present = pos < count && levels[pos].price == price;
     
-    int count = 0;
-    for (const auto& [price, level] : bids_) {
-        if (count >= depth) break;
-        result.emplace_back(price, level.total_quantity);
-        count++;
+    if (created && !present) {
+        uint32_t last = std::min<uint32_t>(count, Config::DEPTH_LEVELS - 1);
+        for (uint32_t i = last; i > pos; --i) levels[i] = levels[i - 1];
+        levels[pos] = {price, quantity};
+        count = last + 1;
+    } else if (!present) {
+        rebuild = true;  // A level the image should hold but doesn't; resync
+    } else if (quantity > 0) {
+        levels[pos].quantity = quantity;
+    } else if (count == Config::DEPTH_LEVELS) {
+        rebuild = true;
+    } else {
+        for (uint32_t i = pos + 1; i < count; ++i) levels[i - 1] = levels[i];
+        count--;
     }
+}
+
+template <typename Ladder>
+void OrderBook::rebuildDepth(const Ladder& book, DepthImage::Level* levels, uint32_t& count) {
+    count = 0;
+    book.forEach([&](const PriceLevel& level) {
+        levels[count++] = {level.price, level.total_quantity};
+        return count < Config::DEPTH_LEVELS;
+    });
+}
+
+void OrderBook::publishDepth() {
+    if (rebuild_bids_) rebuildDepth(bids_, depth_working_.bids, depth_working_.bid_count);
+    if (rebuild_asks_) rebuildDepth(asks_, depth_working_.asks, depth_working_.ask_count);
+    rebuild_bids_ = rebuild_asks_ = false;
     
-    return result;
+    depth_working_.sequence = book_version_;
+    uint32_t back = depth_front_.load(std::memory_order_relaxed) ^ 1;
+    depth_buffers_[back].store(depth_working_);
+    depth_front_.store(back, std::memory_order_release);
 }
 
-std::vector<std::pair<Price, Quantity>> OrderBook::getAsks(int depth) const {
+DepthImage OrderBook::getDepth() const {
+    return depth_buffers_[depth_front_.load(std::memory_order_acquire)].load();
+}
+
+std::vector<std::pair<Price, Quantity>> OrderBook::depthSide(OrderSide side, int depth) const {
     std::vector<std::pair<Price, Quantity>> result;
-    result.reserve(depth);
-    
-    int count = 0;
-    for (const auto& [price, level] : asks_) {
-        if (count >= depth) break;
-        result.emplace_back(price, level.total_quantity);
-        count++;
+    if (depth > static_cast<int>(Config::DEPTH_LEVELS)) {
+        std::lock_guard<Mutex> lock(book_mutex_);
+        if (side == OrderSide::BUY) {
+            collectDepth(bids_, depth, result);
+        } else {
+            collectDepth(asks_, depth, result);
+        }
+        return result;
     }
     
+    DepthImage image = getDepth();
+    const DepthImage::Level* levels = (side == OrderSide::BUY) ? image.bids : image.asks;
+    uint32_t count = (side == OrderSide::BUY) ? image.bid_count : image.ask_count;
+    count = std::min<uint32_t>(count, static_cast<uint32_t>(std::max(depth, 0)));
+    result.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        result.emplace_back(levels[i].price, levels[i].quantity);
+    }
     return result;
 }
 
-OrderPtr OrderBook::getOrder(const OrderId& order_id) const {
+template <typename Ladder>
+void OrderBook::collectDepth(const Ladder& book, int depth,
+                             std::vector<std::pair<Price, Quantity>>& out) const {
+    out.reserve(depth);
+    book.forEach([&](const PriceLevel& level) {
+        if (static_cast<int>(out.size()) >= depth) return false;
+        out.emplace_back(level.price, level.total_quantity);
+        return true;
+    });
+}
+
+std::vector<std::pair<Price, Quantity>> OrderBook::getBids(int depth) const {
+    return depthSide(OrderSide::BUY, depth);
+}
+
+std::vector<std::pair<Price, Quantity>> OrderBook::getAsks(int depth) const {
+    return depthSide(OrderSide::SELL, depth);
+}
+
+Order* OrderBook::getOrder(OrderId order_id) const {
     auto it = order_map_.find(order_id);
     return (it != order_map_.end()) ? it->second : nullptr;
 }
 
-double OrderBook::getSpread() const {
-    if (best_bid_.has_value() && best_ask_.has_value()) {
-        return best_ask_.value() - best_bid_.value();
+Price OrderBook::getSpread() const {
+    TopOfBook top = top_.load();
+    if (top.hasBid() && top.hasAsk()) {
+        return top.ask_price - top.bid_price;
     }
-    return 0.0;
+    return 0;
 }
 
 
+bool OrderBook::checkConsistency() const {
+    std::lock_guard<Mutex> lock(book_mutex_);
+    
+    bool ok = true;
+    size_t resting = 0;
+    auto check = [&](const PriceLevel& level) {
+        ok = ok && !level.isEmpty() && level.checkConsistency();
+        resting += level.order_count;
+        return ok;
+    };
+    bids_.forEach(check);
+    asks_.forEach(check);
+    return ok && resting == order_map_.size();
+}
+
 size_t OrderBook::totalOrders() const {
-    std::lock_guard<std::mutex> lock(book_mutex_);
+    std::lock_guard<Mutex> lock(book_mutex_);
     return order_map_.size();
 }
 
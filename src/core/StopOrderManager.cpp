@@ -1,119 +1,134 @@
 #include "core/StopOrderManager.hpp"
+#include "core/AsyncLogger.hpp"
 #include <algorithm>
-#include <iostream>
 
 namespace MatchingEngine {
 
+StopOrderManager::StopBook& StopOrderManager::bookFor(SymbolStops& stops, const Order& order) {
+    bool take_profit = order.type == OrderType::TAKE_PROFIT;
+    if (order.side == OrderSide::BUY) {
+        return take_profit ? stops.buy_take_profits : stops.buy_stops;
+    }
+    return take_profit ? stops.sell_take_profits : stops.sell_stops;
+}
+
+// Convert a triggered stop to its executable order type
+void StopOrderManager::activate(Order& order) {
+    if (order.type == OrderType::STOP_LOSS) {
+        // Stop-loss becomes a MARKET order
+        order.type = OrderType::MARKET;
+        order.price = 0;
+    } else if (order.type == OrderType::STOP_LIMIT) {
+        // Stop-limit becomes a LIMIT order at its limit price
+        order.type = OrderType::LIMIT;
+        // order.price already set to limit price
+    } else if (order.type == OrderType::TAKE_PROFIT) {
+        // Take-profit becomes a MARKET order
+        order.type = OrderType::MARKET;
+        order.price = 0;
+    }
+}
+
 // Add a stop order to the manager
-void StopOrderManager::addStopOrder(OrderPtr order) {
-    if (!order || !order->isStopOrder()) {
-        std::cerr << "Error: Attempted to add non-stop order to StopOrderManager" << std::endl;
+void StopOrderManager::addStopOrder(Order& order) {
+    if (!order.isStopOrder()) {
+        ME_LOG_ERROR("[StopOrderManager] Attempted to add non-stop order {}", order.order_id);
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<Mutex> lock(mutex_);
     
-    order->status = OrderStatus::PENDING;  // Pending trigger
-    stop_orders_[order->symbol].push_back(order);
+    order.status = OrderStatus::PENDING;  // Pending trigger
+    SymbolStops& stops = stop_orders_[order.symbol_id];
+    StopBook& book = bookFor(stops, order);
+    auto level = book.try_emplace(order.stop_price).first;
+    auto node = level->second.insert(level->second.end(), &order);
+    index_[order.order_id] = StopLocation{&stops, &book, level, node};
+    stops.count++;
+    total_count_.fetch_add(1, std::memory_order_relaxed);
     
-    std::cout << "[StopOrderManager] Added " << orderTypeToString(order->type) 
-              << " order " << order->order_id 
-              << " with stop price " << order->stop_price << std::endl;
+    ME_LOG_DEBUG("[StopOrderManager] Added {} order {} with stop price {}",
+                 orderTypeName(order.type), order.order_id, order.stop_price);
 }
 
 // Check and trigger stop orders
-std::vector<OrderPtr> StopOrderManager::checkTriggers(const Symbol& symbol, Price last_trade_price) {
-    std::lock_guard<std::mutex> lock(mutex_);
+std::vector<Order*> StopOrderManager::checkTriggers(SymbolId symbol_id, Price low, Price high) {
+    std::lock_guard<Mutex> lock(mutex_);
     
-    std::vector<OrderPtr> triggered;
+    std::vector<Order*> triggered;
     
-    auto it = stop_orders_.find(symbol);
-    if (it == stop_orders_.end() || it->second.empty()) {
+    auto it = stop_orders_.find(symbol_id);
+    if (it == stop_orders_.end() || it->second.count == 0) {
         return triggered;
     }
     
-    auto& orders = it->second;
+    SymbolStops& stops = it->second;
     
-    // Check each stop order
-    for (auto order_it = orders.begin(); order_it != orders.end(); ) {
-        auto& order = *order_it;
-        
-        if (order->shouldTrigger(last_trade_price)) {
-            std::cout << "[StopOrderManager] TRIGGERED: " << orderTypeToString(order->type)
-                      << " order " << order->order_id
-                      << " at stop price " << order->stop_price
-                      << " (market price: " << last_trade_price << ")" << std::endl;
-            
-            // Convert stop order to executable order
-            if (order->type == OrderType::STOP_LOSS) {
-                // Stop-loss becomes a MARKET order
-                order->type = OrderType::MARKET;
-                order->price = 0.0;
-            } else if (order->type == OrderType::STOP_LIMIT) {
-                // Stop-limit becomes a LIMIT order at its limit price
-                order->type = OrderType::LIMIT;
-                // order->price already set to limit price
-            } else if (order->type == OrderType::TAKE_PROFIT) {
-                // Take-profit becomes a MARKET order
-                order->type = OrderType::MARKET;
-                order->price = 0.0;
-            }
-            
-            triggered.push_back(order);
-            order_it = orders.erase(order_it);
-        } else {
-            ++order_it;
+    // Rising books: every level at or below the high; falling books: every
+    // level at or above the low
+    auto take = [&triggered](StopBook& book, StopBook::iterator first, StopBook::iterator last) {
+        for (auto level = first; level != last; ++level) {
+            triggered.insert(triggered.end(), level->second.begin(), level->second.end());
         }
+        book.erase(first, last);
+    };
+    take(stops.buy_stops, stops.buy_stops.begin(), stops.buy_stops.upper_bound(high));
+    take(stops.sell_take_profits, stops.sell_take_profits.begin(),
+         stops.sell_take_profits.upper_bound(high));
+    take(stops.sell_stops, stops.sell_stops.lower_bound(low), stops.sell_stops.end());
+    take(stops.buy_take_profits, stops.buy_take_profits.lower_bound(low),
+         stops.buy_take_profits.end());
+    
+    if (triggered.empty()) return triggered;
+    stops.count -= triggered.size();
+    total_count_.fetch_sub(triggered.size(), std::memory_order_relaxed);
+    for (const Order* order : triggered) {
+        index_.erase(order->order_id);
+    }
+    
+    // Same order the stops would have fired in had they been scanned by arrival
+    std::sort(triggered.begin(), triggered.end(), [](const Order* a, const Order* b) {
+        return a->order_id < b->order_id;
+    });
+    
+    for (Order* order : triggered) {
+        ME_LOG_DEBUG("[StopOrderManager] TRIGGERED: {} order {} at stop price {} (market range: {}-{})",
+                     orderTypeName(order->type), order->order_id, order->stop_price, low, high);
+        activate(*order);
     }
     
     return triggered;
 }
 
 // Cancel a stop order
-bool StopOrderManager::cancelStopOrder(const OrderId& order_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool StopOrderManager::cancelStopOrder(OrderId order_id) {
+    std::lock_guard<Mutex> lock(mutex_);
     
-    // Search all symbols
-    for (auto& [symbol, orders] : stop_orders_) {
-        auto it = std::find_if(orders.begin(), orders.end(),
-            [&order_id](const OrderPtr& order) {
-                return order->order_id == order_id;
-            });
-        
-        if (it != orders.end()) {
-            (*it)->status = OrderStatus::CANCELLED;
-            orders.erase(it);
-            
-            std::cout << "[StopOrderManager] Cancelled stop order " << order_id << std::endl;
-            return true;
-        }
-    }
+    auto it = index_.find(order_id);
+    if (it == index_.end()) return false;
+    
+    StopLocation& location = it->second;
+    Order* order = *location.node;
+    location.level->second.erase(location.node);
+    if (location.level->second.empty()) location.book->erase(location.level);
+    location.stops->count--;
+    index_.erase(it);
+    total_count_.fetch_sub(1, std::memory_order_relaxed);
+    order->status = OrderStatus::CANCELLED;
     
-    return false;
+    ME_LOG_DEBUG("[StopOrderManager] Cancelled stop order {}", order_id);
+    return true;
 }
 
-// Get all stop orders for a symbol
-std::vector<OrderPtr> StopOrderManager::getStopOrders(const Symbol& symbol) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto it = stop_orders_.find(symbol);
-    if (it != stop_orders_.end()) {
-        return it->second;
-    }
-    
-    return {};
+bool StopOrderManager::contains(OrderId order_id) const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return index_.count(order_id) > 0;
 }
 
-// Get the total count of stop orders
-size_t StopOrderManager::getStopOrderCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    size_t count = 0;
-    for (const auto& [symbol, orders] : stop_orders_) {
-        count += orders.size();
-    }
-    
-    return count;
+size_t StopOrderManager::getStopOrderCount(SymbolId symbol_id) const {
+    std::lock_guard<Mutex> lock(mutex_);
+    auto it = stop_orders_.find(symbol_id);
+    return it == stop_orders_.end() ? 0 : it->second.count;
 }
 
 } // namespace MatchingEngine
@@ -0,0 +1,60 @@
+#include "core/SymbolRegistry.hpp"
+#include <functional>
+
+namespace MatchingEngine {
+
+// Hash table is at least twice the capacity, so probes stay short and a
+// probe sequence always reaches an empty slot
+static size_t slotCountFor(size_t capacity) {
+    size_t slots = 16;
+    while (slots < capacity * 2) slots <<= 1;
+    return slots;
+}
+
+SymbolRegistry::SymbolRegistry(size_t capacity)
+    : capacity_(capacity),
+      slot_mask_(slotCountFor(capacity) - 1),
+      entries_(new Entry[capacity]),
+      slots_(new std::atomic<uint32_t>[slot_mask_ + 1]),
+      count_(0) {
+    for (size_t i = 0; i <= slot_mask_; ++i) {
+        slots_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+SymbolId SymbolRegistry::find(const Symbol& name) const {
+    for (size_t i = std::hash<Symbol>{}(name) & slot_mask_; ; i = (i + 1) & slot_mask_) {
+        uint32_t slot = slots_[i].load(std::memory_order_acquire);
+        if (slot == 0) return Config::INVALID_SYMBOL;
+        if (entries_[slot - 1].name == name) return slot - 1;
+    }
+}
+
+SymbolId SymbolRegistry::intern(const Symbol& name) {
+    SymbolId id = find(name);
+    if (id != Config::INVALID_SYMBOL || name.empty()) return id;
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    size_t i = std::hash<Symbol>{}(name) & slot_mask_;
+    for (uint32_t slot; (slot = slots_[i].load(std::memory_order_relaxed)) != 0;
+         i = (i + 1) & slot_mask_) {
+        if (entries_[slot - 1].name == name) return slot - 1;  // Raced with another writer
+    }
+
+    size_t count = count_.load(std::memory_order_relaxed);
+    if (count == capacity_) return Config::INVALID_SYMBOL;
+
+    id = static_cast<SymbolId>(count);
+    entries_[id].name = name;
+    slots_[i].store(id + 1, std::memory_order_release);
+    count_.store(count + 1, std::memory_order_release);
+    return id;
+}
+
+void SymbolRegistry::setSpec(SymbolId id, const SymbolSpec& spec) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    entries_[id].spec = spec;
+}
+
+} // namespace MatchingEngine
@@ -0,0 +1,122 @@
+#include "core/TerminalOrderStore.hpp"
+#include <algorithm>
+
+namespace MatchingEngine {
+
+static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+// At least twice the capacity, so probe runs stay short
+static size_t indexSizeFor(size_t capacity) {
+    size_t slots = 16;
+    while (slots < capacity * 2) slots <<= 1;
+    return slots;
+}
+
+TerminalOrderStore::TerminalOrderStore(size_t capacity, uint64_t max_age_ns)
+    : capacity_(capacity > 0 ? capacity : 1), max_age_ns_(max_age_ns),
+      ring_(new Record[capacity_]),
+      index_mask_(indexSizeFor(capacity_) - 1),
+      index_(new uint32_t[index_mask_ + 1]()) {}
+
+size_t TerminalOrderStore::home(OrderId order_id) const {
+    // Ids are sequential; a multiplicative hash spreads them over the table
+    return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ull) >> 32) & index_mask_;
+}
+
+size_t TerminalOrderStore::findSlot(OrderId order_id) const {
+    for (size_t i = home(order_id); ; i = (i + 1) & index_mask_) {
+        uint32_t entry = index_[i];
+        if (entry == EMPTY) return NPOS;
+        if (ring_[entry - 1].order_id == order_id) return i;
+    }
+}
+
+// Backward-shift deletion: keeps probe runs intact without tombstones
+void TerminalOrderStore::unindex(size_t slot) {
+    size_t hole = slot;
+    for (size_t i = (slot + 1) & index_mask_; index_[i] != EMPTY; i = (i + 1) & index_mask_) {
+        size_t want = home(ring_[index_[i] - 1].order_id);
+        // Move the entry into the hole unless its home lies in (hole, i]
+        bool stays = (hole <= i) ? (hole < want && want <= i) : (hole < want || want <= i);
+        if (!stays) {
+            index_[hole] = index_[i];
+            hole = i;
+        }
+    }
+    index_[hole] = EMPTY;
+}
+
+void TerminalOrderStore::evictOldest() {
+    size_t slot = findSlot(ring_[head_].order_id);
+    if (slot != NPOS) unindex(slot);
+    head_ = (head_ + 1) % capacity_;
+    count_--;
+    evicted_++;
+}
+
+bool TerminalOrderStore::expired(const Record& record, Timestamp now) const {
+    // A record stamped after `now` (read earlier by the caller) is brand new
+    return max_age_ns_ > 0 && record.retired_at <= now && now - record.retired_at > max_age_ns_;
+}
+
+void TerminalOrderStore::expire(Timestamp now) {
+    while (count_ > 0 && expired(ring_[head_], now)) {
+        evictOldest();
+    }
+}
+
+void TerminalOrderStore::insert(const Order& order, Timestamp now) {
+    size_t slot = findSlot(order.order_id);
+    Record* record;
+    if (slot != NPOS) {
+        // Retired twice: refresh in place, keeping its age so the ring stays ordered
+        record = &ring_[index_[slot] - 1];
+    } else {
+        expire(now);
+        if (count_ == capacity_) evictOldest();
+        // Never older than the newest record, so expiry can pop from the head
+        if (count_ > 0) {
+            now = std::max(now, ring_[(head_ + count_ - 1) % capacity_].retired_at);
+        }
+        size_t pos = (head_ + count_) % capacity_;
+        count_++;
+        record = &ring_[pos];
+        record->order_id = order.order_id;
+        record->retired_at = now;
+
+        size_t i = home(order.order_id);
+        while (index_[i] != EMPTY) i = (i + 1) & index_mask_;
+        index_[i] = static_cast<uint32_t>(pos + 1);
+    }
+
+    record->symbol_id = order.symbol_id;
+    record->type = order.type;
+    record->side = order.side;
+    record->status = order.status;
+    record->price = order.price;
+    record->stop_price = order.stop_price;
+    record->quantity = order.quantity;
+    record->filled_quantity = order.filled_quantity;
+    record->average_fill_price = order.average_fill_price;
+    record->timestamp = order.timestamp;
+}
+
+const TerminalOrderStore::Record* TerminalOrderStore::find(OrderId order_id, Timestamp now) const {
+    size_t slot = findSlot(order_id);
+    if (slot == NPOS) return nullptr;
+    const Record& record = ring_[index_[slot] - 1];
+    return expired(record, now) ? nullptr : &record;
+}
+
+Order TerminalOrderStore::toOrder(const Record& record) {
+    Order order(record.order_id, record.symbol_id, record.type, record.side,
+                record.price, record.quantity);
+    order.status = record.status;
+    order.stop_price = record.stop_price;
+    order.filled_quantity = record.filled_quantity;
+    order.average_fill_price = record.average_fill_price;
+    order.timestamp = record.timestamp;
+    return order;
+}
+
+} // namespace MatchingEngine
@@ -1,11 +1,16 @@
 #include "core/MatchingEngine.hpp"
+#include "core/AsyncLogger.hpp"
 #include "api/RestAPIServer.hpp"
 #include "api/WebSocketServer.hpp"
 #include "publishers/MarketDataPublisher.hpp"
 #include "publishers/TradePublisher.hpp"
 #include <iostream>
+#include <fstream>
+#include <string>
 #include <signal.h>
 #include <atomic>
+#include <cstdlib>
+#include <thread>
 
 using namespace MatchingEngine;
 
@@ -16,6 +21,20 @@ void signal_handler(int signal) {
     keep_running = false;
 }
 
+// One symbol per line; blank lines and lines starting with '#' are skipped
+static bool loadSymbols(MatchingEngineCore& engine, const char* path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        engine.setSymbolSpec(line, SymbolSpec{});
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     // Setup signal handler
     signal(SIGINT, signal_handler);
@@ -26,20 +45,51 @@ int main(int argc, char* argv[]) {
     std::cout << "========================================" << std::endl;
     std::cout << std::endl;
     
-    // Create matching engine
-    MatchingEngineCore engine;
+    // --shards N: spread symbols over N single-writer matcher threads
+    // (default 0: match inline on the REST/WebSocket threads)
+    // --symbols FILE: symbols to trade besides BTC-USDT and ETH-USDT
+    EngineConfig config;
+    config.clock_source = ClockSource::TSC;
+    const char* symbols_path = nullptr;
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shards") {
+            config.shard_count = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--symbols") {
+            symbols_path = argv[++i];
+        }
+    }
+    MatchingEngineCore engine(config);
+    
+    // Busy books get a dense tick ladder; everything else uses the tree book
+    SymbolSpec ladder_spec;
+    ladder_spec.ladder_ticks = 16384;
+    engine.setSymbolSpec("BTC-USDT", ladder_spec);
+    engine.setSymbolSpec("ETH-USDT", ladder_spec);
+    
+    // Orders for any symbol not configured here are rejected
+    if (symbols_path && !loadSymbols(engine, symbols_path)) {
+        std::cerr << "Error: cannot read symbol file " << symbols_path << std::endl;
+        return 1;
+    }
     
     // Create WebSocket servers
     API::WebSocketServer market_data_ws(8081);
     API::WebSocketServer trade_ws(8082);
     
     // Create publishers
-    Publishers::TradePublisher trade_publisher(trade_ws);
+    Publishers::TradePublisher trade_publisher(engine, trade_ws);
     Publishers::MarketDataPublisher market_data_publisher(engine, market_data_ws);
     
     // Set up callbacks
     engine.setTradeCallback([&](const Trade& trade) {
-        std::cout << "Trade: " << trade.toJson() << std::endl;
+        // Logged asynchronously so a slow terminal never delays matching;
+        // symbol names live as long as the engine
+        const SymbolSpec spec = engine.getSymbolSpec(trade.symbol_id);
+        ME_LOG_INFO("Trade {}: {} {} @ {} (maker {}, taker {})", trade.trade_id,
+                    engine.getSymbolName(trade.symbol_id).c_str(),
+                    trade.quantity * spec.lot_size, trade.price * spec.tick_size,
+                    trade.maker_order_id, trade.taker_order_id);
         trade_publisher.publishTrade(trade);
         
         // Note: Market data will be published by processLimitOrder
@@ -47,9 +97,10 @@ int main(int argc, char* argv[]) {
         // No need to publish here for fully filled orders
     });
     
-    // Callback when orders are added to book (before any matching)
-    engine.setBookUpdateCallback([&](const Symbol& symbol) {
-        market_data_publisher.publishSnapshot(symbol);
+    // Level deltas stream as books change; the publisher thread follows
+    // up with periodic snapshots of changed books for resync
+    engine.setLevelUpdateCallback([&](SymbolId symbol_id, const std::vector<LevelUpdate>& updates) {
+        market_data_publisher.publishLevelUpdates(symbol_id, updates);
     });
     
     // Start servers
@@ -69,12 +120,19 @@ int main(int argc, char* argv[]) {
         std::cout << "REST API:        http://localhost:8080" << std::endl;
         std::cout << "Market Data WS:  ws://localhost:8081" << std::endl;
         std::cout << "Trade Feed WS:   ws://localhost:8082" << std::endl;
+        std::cout << "Matching:        "
+                  << (config.shard_count ? std::to_string(config.shard_count) + " shard threads"
+                                         : std::string("inline"))
+                  << std::endl;
         std::cout << std::endl;
         std::cout << "API Endpoints:" << std::endl;
         std::cout << "  POST   /api/v1/orders           - Submit order" << std::endl;
+        std::cout << "  POST   /api/v1/orders/batch     - Submit a JSON array of orders" << std::endl;
         std::cout << "  GET    /api/v1/orders/{id}      - Get order status" << std::endl;
         std::cout << "  DELETE /api/v1/orders/{id}      - Cancel order" << std::endl;
         std::cout << "  GET    /api/v1/orderbook/{sym}  - Get order book" << std::endl;
+        std::cout << "  GET    /api/v1/bbo/{sym}        - Get best bid/offer" << std::endl;
+        std::cout << "  GET    /metrics                 - Prometheus latency metrics" << std::endl;
         std::cout << std::endl;
         std::cout << "Press Ctrl+C to stop..." << std::endl;
         std::cout << "========================================" << std::endl;
@@ -83,6 +141,7 @@ int main(int argc, char* argv[]) {
         // Keep running until signal
         while (keep_running) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
+            engine.clock().recalibrate();  // Keep the TSC clock on wall time
             
             // Print statistics
             if (engine.getTotalTradesExecuted() > 0) {
@@ -105,6 +164,8 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Pending records may point at symbol names owned by the engine
+    AsyncLogger::instance().flush();
     std::cout << "Server stopped cleanly" << std::endl;
     
     return 0;
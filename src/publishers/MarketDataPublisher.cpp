@@ -1,7 +1,7 @@
 #include "publishers/MarketDataPublisher.hpp"
 #include <iostream>
 #include <sstream>
-#include <iomanip>
+#include <algorithm>
 
 namespace MatchingEngine {
 namespace Publishers {
@@ -35,58 +35,97 @@ void MarketDataPublisher::stop() {
     std::cout << "Market Data Publisher stopped" << std::endl;
 }
 
-void MarketDataPublisher::publishSnapshot(const Symbol& symbol) {
-    auto book = engine_.getOrderBook(symbol);
+void MarketDataPublisher::publishSnapshot(SymbolId symbol_id) {
+    OrderBook* book = engine_.getOrderBook(symbol_id);
     if (!book) return;
     
-    auto bids = book->getBids(10);
-    auto asks = book->getAsks(10);
+    // One consistent image of both sides, read without the book lock
+    DepthImage depth = book->getDepth();
+    const uint32_t bid_levels = std::min<uint32_t>(depth.bid_count, 10);
+    const uint32_t ask_levels = std::min<uint32_t>(depth.ask_count, 10);
     
-    // Get current timestamp
-    auto now = std::chrono::system_clock::now();
-    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        now.time_since_epoch()).count();
-    auto now_sec = now_ns / 1000000000;
-    auto now_nsec = now_ns % 1000000000;
+    API::OrderBookSnapshot snapshot;
+    snapshot.timestamp = API::formatTimestamp(engine_.clock().now());
+    snapshot.symbol = engine_.getSymbolName(symbol_id);
     
-    std::time_t time = static_cast<std::time_t>(now_sec);
-    std::tm* tm_info = std::gmtime(&time);
+    const SymbolSpec& spec = book->getSpec();
+    snapshot.sequence = depth.sequence;
+    for (uint32_t i = 0; i < bid_levels; ++i) {
+        snapshot.bids.emplace_back(API::formatPrice(depth.bids[i].price, spec),
+                                   API::formatQuantity(depth.bids[i].quantity, spec));
+    }
     
-    char time_buffer[80];
-    std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%dT%H:%M:%S", tm_info);
+    for (uint32_t i = 0; i < ask_levels; ++i) {
+        snapshot.asks.emplace_back(API::formatPrice(depth.asks[i].price, spec),
+                                   API::formatQuantity(depth.asks[i].quantity, spec));
+    }
     
-    std::ostringstream timestamp;
-    timestamp << time_buffer << "." << std::setfill('0') << std::setw(9) << now_nsec << "Z";
+    // Broadcast to all WebSocket clients
+    broadcast(symbol_id, snapshot.toJson());
+}
+
+void MarketDataPublisher::publishLevelUpdates(SymbolId symbol_id,
+                                              const std::vector<LevelUpdate>& updates) {
+    if (updates.empty()) return;
     
-    API::OrderBookSnapshot snapshot;
-    snapshot.timestamp = timestamp.str();
-    snapshot.symbol = symbol;
+    OrderBook* book = engine_.getOrderBook(symbol_id);
+    if (!book) return;
+    const SymbolSpec& spec = book->getSpec();
     
-    for (const auto& [price, qty] : bids) {
-        std::ostringstream p, q;
-        p << std::fixed << std::setprecision(2) << price;
-        q << std::fixed << std::setprecision(8) << qty;
-        snapshot.bids.emplace_back(p.str(), q.str());
+    API::OrderBookDelta delta;
+    delta.symbol = engine_.getSymbolName(symbol_id);
+    delta.first_sequence = updates.front().sequence;
+    delta.sequence = updates.back().sequence;
+    for (const auto& update : updates) {
+        auto& side = (update.side == OrderSide::BUY) ? delta.bids : delta.asks;
+        side.emplace_back(API::formatPrice(update.price, spec),
+                          API::formatQuantity(update.quantity, spec));
     }
     
-    for (const auto& [price, qty] : asks) {
-        std::ostringstream p, q;
-        p << std::fixed << std::setprecision(2) << price;
-        q << std::fixed << std::setprecision(8) << qty;
-        snapshot.asks.emplace_back(p.str(), q.str());
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        DeltaStream& stream = streams_[symbol_id];
+        if (delta.sequence >= stream.next_sequence) {  // Else behind a gap given up on
+            stream.held.emplace(delta.first_sequence, HeldDelta{delta.sequence, delta.toJson()});
+        }
+        
+        // Send every delta that is now contiguous; a full buffer skips the gap
+        auto it = stream.held.begin();
+        while (it != stream.held.end() &&
+               (it->first <= stream.next_sequence || stream.held.size() > MAX_HELD_DELTAS)) {
+            broadcast(symbol_id, it->second.json);
+            stream.next_sequence = it->second.sequence + 1;
+            it = stream.held.erase(it);
+        }
     }
     
-    // Broadcast to all WebSocket clients
-    ws_server_.broadcast(snapshot.toJson());
+    {
+        std::lock_guard<std::mutex> lock(changed_mutex_);
+        changed_symbols_.insert(symbol_id);
+    }
+}
+
+void MarketDataPublisher::broadcast(SymbolId symbol_id, const std::string& message) {
+    LatencyMetrics& metrics = engine_.latencyMetrics();
+    uint64_t started = metrics.start();
+    ws_server_.broadcast(message);
+    metrics.recordSince(LatencyStage::WS_BROADCAST, symbol_id, LatencyMetrics::NO_ORDER_TYPE, started);
 }
 
 void MarketDataPublisher::publishLoop() {
     while (running_) {
-        // For now, we don't have a list of active symbols
-        // In production, you'd maintain a set of symbols to publish
-        // For demo purposes, this method is called on-demand via publishSnapshot
-        
         std::this_thread::sleep_for(std::chrono::milliseconds(update_interval_ms_));
+        
+        // Resync snapshots only for books that moved since the last round;
+        // they come from the lock-free depth image, off the matcher thread
+        std::unordered_set<SymbolId> changed;
+        {
+            std::lock_guard<std::mutex> lock(changed_mutex_);
+            changed.swap(changed_symbols_);
+        }
+        for (SymbolId symbol_id : changed) {
+            publishSnapshot(symbol_id);
+        }
     }
 }
 
@@ -1,14 +1,21 @@
 #include "publishers/TradePublisher.hpp"
+#include "api/Messages.hpp"
 
 namespace MatchingEngine {
 namespace Publishers {
 
-TradePublisher::TradePublisher(API::WebSocketServer& ws_server)
-    : ws_server_(ws_server) {}
+TradePublisher::TradePublisher(MatchingEngineCore& engine, API::WebSocketServer& ws_server)
+    : engine_(engine), ws_server_(ws_server) {}
 
 void TradePublisher::publishTrade(const Trade& trade) {
     // Broadcast trade to all WebSocket clients
-    ws_server_.broadcast(trade.toJson());
+    auto report = API::TradeReport::fromTrade(trade, engine_.getSymbolName(trade.symbol_id),
+                                              engine_.getSymbolSpec(trade.symbol_id));
+    LatencyMetrics& metrics = engine_.latencyMetrics();
+    uint64_t started = metrics.start();
+    ws_server_.broadcast(report.toJson());
+    metrics.recordSince(LatencyStage::WS_BROADCAST, trade.symbol_id,
+                        LatencyMetrics::NO_ORDER_TYPE, started);
 }
 
 } // namespace Publishers
@@ -108,5 +108,15 @@ else
 fi
 echo ""
 
+echo "Test 9: Out-of-range numbers are a bad request"
+CODE_PRICE=$(curl -s -o /dev/null -w "%{http_code}" -X POST $API/orders -d '{"symbol":"TEST-L11","order_type":"limit","side":"buy","quantity":1.0,"price":1e300}')
+CODE_QTY=$(curl -s -o /dev/null -w "%{http_code}" -X POST $API/orders -d '{"symbol":"TEST-L11","order_type":"limit","side":"buy","quantity":1e999,"price":50000}')
+if [ "$CODE_PRICE" = "400" ] && [ "$CODE_QTY" = "400" ]; then
+    pass_test "Out-of-range price and quantity rejected with 400"
+else
+    fail_test "Expected 400, got $CODE_PRICE / $CODE_QTY"
+fi
+echo ""
+
 echo "Results: PASSED=$PASS FAILED=$FAIL"
 [ $FAIL -eq 0 ] && exit 0 || exit 1
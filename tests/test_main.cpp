@@ -1,13 +1,24 @@
 #include "../include/core/MatchingEngine.hpp"
+#include "../include/core/AsyncLogger.hpp"
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <random>
+#include <map>
 
 using namespace MatchingEngine;
 
+// Default grid: 0.01 tick, 1e-8 lot
+static Price px(double price) { return static_cast<Price>(std::llround(price * 100.0)); }
+static Quantity qty(double quantity) { return static_cast<Quantity>(std::llround(quantity * 1e8)); }
+
 void test_simple_match() {
     std::cout << "Test: Simple Match... ";
     
     MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
     int trade_count = 0;
     
     engine.setTradeCallback([&](const Trade& trade) {
@@ -15,13 +26,13 @@ void test_simple_match() {
     });
     
     // Submit sell order
-    auto sell = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                         OrderSide::SELL, 50000.0, 1.0);
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::SELL, px(50000.0), qty(1.0));
     engine.submitOrder(sell);
     
     // Submit matching buy order
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                        OrderSide::BUY, 50000.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                        OrderSide::BUY, px(50000.0), qty(1.0));
     engine.submitOrder(buy);
     
     assert(trade_count == 1);
@@ -35,20 +46,21 @@ void test_partial_fill() {
     std::cout << "Test: Partial Fill... ";
     
     MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
     
     // Sell 2.0
-    auto sell = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                         OrderSide::SELL, 50000.0, 2.0);
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::SELL, px(50000.0), qty(2.0));
     engine.submitOrder(sell);
     
     // Buy 1.0
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                        OrderSide::BUY, 50000.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                        OrderSide::BUY, px(50000.0), qty(1.0));
     engine.submitOrder(buy);
     
     assert(buy->status == OrderStatus::FILLED);
     assert(sell->status == OrderStatus::PARTIAL_FILL);
-    assert(sell->remainingQuantity() == 1.0);
+    assert(sell->remainingQuantity() == qty(1.0));
     
     std::cout << "PASS\n";
 }
@@ -57,15 +69,16 @@ void test_market_order() {
     std::cout << "Test: Market Order... ";
     
     MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
     
     // Add sell order
-    auto sell = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                         OrderSide::SELL, 50000.0, 1.0);
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::SELL, px(50000.0), qty(1.0));
     engine.submitOrder(sell);
     
     // Market buy
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::MARKET, 
-                                        OrderSide::BUY, 0.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::MARKET, 
+                                        OrderSide::BUY, 0, qty(1.0));
     engine.submitOrder(buy);
     
     assert(buy->status == OrderStatus::FILLED);
@@ -78,19 +91,20 @@ void test_ioc_order() {
     std::cout << "Test: IOC Order... ";
     
     MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
     
     // Add sell for 0.5
-    auto sell = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                         OrderSide::SELL, 50000.0, 0.5);
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::SELL, px(50000.0), qty(0.5));
     engine.submitOrder(sell);
     
     // IOC buy for 1.0 - should fill 0.5, cancel 0.5
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::IOC, 
-                                        OrderSide::BUY, 50000.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::IOC, 
+                                        OrderSide::BUY, px(50000.0), qty(1.0));
     engine.submitOrder(buy);
     
     assert(buy->status == OrderStatus::PARTIAL_FILL);
-    assert(buy->filled_quantity == 0.5);
+    assert(buy->filled_quantity == qty(0.5));
     
     std::cout << "PASS\n";
 }
@@ -99,18 +113,19 @@ void test_fok_success() {
     std::cout << "Test: FOK Success... ";
     
     MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
     
     // Add enough liquidity
-    auto sell1 = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                          OrderSide::SELL, 50000.0, 0.8);
-    auto sell2 = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                          OrderSide::SELL, 50100.0, 0.5);
+    auto sell1 = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                          OrderSide::SELL, px(50000.0), qty(0.8));
+    auto sell2 = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                          OrderSide::SELL, px(50100.0), qty(0.5));
     engine.submitOrder(sell1);
     engine.submitOrder(sell2);
     
     // FOK for 1.0 - can be filled
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::FOK, 
-                                        OrderSide::BUY, 50100.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::FOK, 
+                                        OrderSide::BUY, px(50100.0), qty(1.0));
     engine.submitOrder(buy);
     
     assert(buy->status == OrderStatus::FILLED);
@@ -122,19 +137,20 @@ void test_fok_failure() {
     std::cout << "Test: FOK Failure... ";
     
     MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
     
     // Add insufficient liquidity
-    auto sell = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                         OrderSide::SELL, 50000.0, 0.5);
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::SELL, px(50000.0), qty(0.5));
     engine.submitOrder(sell);
     
     // FOK for 1.0 - cannot be filled
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::FOK, 
-                                        OrderSide::BUY, 50000.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::FOK, 
+                                        OrderSide::BUY, px(50000.0), qty(1.0));
     engine.submitOrder(buy);
     
     assert(buy->status == OrderStatus::CANCELLED);
-    assert(buy->filled_quantity == 0.0);
+    assert(buy->filled_quantity == 0);
     
     std::cout << "PASS\n";
 }
@@ -143,31 +159,30 @@ void test_price_time_priority() {
     std::cout << "Test: Price-Time Priority... ";
     
     MatchingEngineCore engine;
-    std::string first_matched;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    OrderId first_matched = 0;
     
     engine.setTradeCallback([&](const Trade& trade) {
-        if (first_matched.empty()) {
+        if (first_matched == 0) {
             first_matched = trade.maker_order_id;
         }
     });
     
     // Add two sell orders at same price
-    auto sell1 = std::make_shared<Order>("FIRST", "BTC-USDT", OrderType::LIMIT, 
-                                          OrderSide::SELL, 50000.0, 1.0);
-    auto sell2 = std::make_shared<Order>("SECOND", "BTC-USDT", OrderType::LIMIT, 
-                                          OrderSide::SELL, 50000.0, 1.0);
-    sell1->order_id = "FIRST";
-    sell2->order_id = "SECOND";
+    auto sell1 = std::make_shared<Order>(1001, BTC, OrderType::LIMIT, 
+                                          OrderSide::SELL, px(50000.0), qty(1.0));
+    auto sell2 = std::make_shared<Order>(1002, BTC, OrderType::LIMIT, 
+                                          OrderSide::SELL, px(50000.0), qty(1.0));
     
     engine.submitOrder(sell1);
     engine.submitOrder(sell2);
     
     // Buy should match with first order
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                        OrderSide::BUY, 50000.0, 1.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                        OrderSide::BUY, px(50000.0), qty(1.0));
     engine.submitOrder(buy);
     
-    assert(first_matched == "FIRST");
+    assert(first_matched == 1001);
     
     std::cout << "PASS\n";
 }
@@ -176,28 +191,1190 @@ void test_no_trade_through() {
     std::cout << "Test: No Trade-Through... ";
     
     MatchingEngineCore engine;
-    std::vector<double> trade_prices;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    std::vector<Price> trade_prices;
     
     engine.setTradeCallback([&](const Trade& trade) {
         trade_prices.push_back(trade.price);
     });
     
     // Add sells at different prices
-    auto sell1 = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                          OrderSide::SELL, 50000.0, 1.0);
-    auto sell2 = std::make_shared<Order>("", "BTC-USDT", OrderType::LIMIT, 
-                                          OrderSide::SELL, 50100.0, 1.0);
+    auto sell1 = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                          OrderSide::SELL, px(50000.0), qty(1.0));
+    auto sell2 = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                          OrderSide::SELL, px(50100.0), qty(1.0));
     engine.submitOrder(sell1);
     engine.submitOrder(sell2);
     
     // Buy 2.0 - should match 50000 first, then 50100
-    auto buy = std::make_shared<Order>("", "BTC-USDT", OrderType::MARKET, 
-                                        OrderSide::BUY, 0.0, 2.0);
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::MARKET, 
+                                        OrderSide::BUY, 0, qty(2.0));
     engine.submitOrder(buy);
     
     assert(trade_prices.size() == 2);
-    assert(trade_prices[0] == 50000.0);  // Best price first!
-    assert(trade_prices[1] == 50100.0);
+    assert(trade_prices[0] == px(50000.0));  // Best price first!
+    assert(trade_prices[1] == px(50100.0));
+    
+    std::cout << "PASS\n";
+}
+
+void test_exact_fractional_fills() {
+    std::cout << "Test: Exact Fractional Fills... ";
+    
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    
+    // 0.1 + 0.2 must fill 0.3 exactly (no epsilon on integer lots)
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::SELL, px(50000.0), qty(0.3));
+    engine.submitOrder(sell);
+    
+    auto buy1 = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::BUY, px(50000.0), qty(0.1));
+    auto buy2 = std::make_shared<Order>(0, BTC, OrderType::LIMIT, 
+                                         OrderSide::BUY, px(50000.0), qty(0.2));
+    engine.submitOrder(buy1);
+    engine.submitOrder(buy2);
+    
+    assert(sell->status == OrderStatus::FILLED);
+    assert(sell->remainingQuantity() == 0);
+    assert(engine.getOrderBook(BTC)->getAsks().empty());
+    assert(engine.getOrderBook(BTC)->getBids().empty());
+    
+    std::cout << "PASS\n";
+}
+
+void test_price_ladder_book() {
+    std::cout << "Test: Price Ladder Book... ";
+    
+    // Tiny window so orders spill to the tree and the window recenters
+    SymbolSpec spec;
+    spec.ladder_ticks = 64;
+    const SymbolId ETH = 0;  // Standalone book, no registry needed
+    OrderBook book(ETH, spec);
+    std::vector<OrderPtr> orders;  // The book only references resting orders
+    const OrderId BID = 1000000;   // Ask ids are their price, bid ids BID + price
+    
+    auto rest = [&](OrderId id, OrderSide side, Price p) {
+        orders.push_back(std::make_shared<Order>(id, ETH, OrderType::LIMIT, side, p, 10));
+        book.addOrder(*orders.back());
+    };
+    
+    std::vector<Price> ask_prices = {1000, 1010, 1063, 1064, 5000, 990, 200000};
+    for (Price p : ask_prices) {
+        rest(p, OrderSide::SELL, p);
+    }
+    std::vector<Price> bid_prices = {900, 950, 20, 989, 100};
+    for (Price p : bid_prices) {
+        rest(BID + p, OrderSide::BUY, p);
+    }
+    
+    auto asks = book.getAsks(100);
+    auto bids = book.getBids(100);
+    assert(asks.size() == ask_prices.size());
+    assert(bids.size() == bid_prices.size());
+    for (size_t i = 1; i < asks.size(); ++i) assert(asks[i - 1].first < asks[i].first);
+    for (size_t i = 1; i < bids.size(); ++i) assert(bids[i - 1].first > bids[i].first);
+    assert(book.getBBO().first == 989);
+    assert(book.getBBO().second == 990);
+    
+    // Cancel the touch; next best must come from wherever it lives
+    assert(book.cancelOrder(990));
+    assert(book.getBBO().second == 1000);
+    
+    // Sweep every ask in price order
+    auto sweep = std::make_shared<Order>(1, ETH, OrderType::MARKET,
+                                         OrderSide::BUY, 0, 60);
+    auto trades = book.matchOrder(*sweep);
+    assert(trades.size() == 6);
+    for (size_t i = 1; i < trades.size(); ++i) assert(trades[i - 1].price < trades[i].price);
+    assert(trades.back().price == 200000);
+    assert(book.getAsks().empty());
+    assert(!book.getBBO().second.has_value());
+    
+    // Drift the bid side far away and back
+    rest(BID + 50000, OrderSide::BUY, 50000);
+    assert(book.getBBO().first == 50000);
+    assert(book.cancelOrder(BID + 50000));
+    assert(book.getBBO().first == 989);
+    assert(book.getBids(100).size() == bid_prices.size());
+    
+    std::cout << "PASS\n";
+}
+
+void test_cancel_within_level() {
+    std::cout << "Test: Cancel Within Level... ";
+    
+    const SymbolId BTC = 0;
+    OrderBook book(BTC);
+    std::vector<OrderPtr> orders;
+    for (OrderId id = 1; id <= 4; ++id) {
+        orders.push_back(std::make_shared<Order>(id, BTC, OrderType::LIMIT,
+                                                 OrderSide::SELL, px(50000.0), qty(1.0)));
+        book.addOrder(*orders.back());
+    }
+    
+    // Unlink from the middle and the back
+    assert(book.cancelOrder(2));
+    assert(book.cancelOrder(4));
+    assert(!book.cancelOrder(4));
+    assert(book.getAsks()[0].second == qty(2.0));
+    
+    auto buy = std::make_shared<Order>(100, BTC, OrderType::MARKET,
+                                       OrderSide::BUY, 0, qty(1.5));
+    auto trades = book.matchOrder(*buy);
+    assert(trades.size() == 2);
+    assert(trades[0].maker_order_id == 1);
+    assert(trades[1].maker_order_id == 3);
+    
+    // Filled makers leave the book; the partial stays cancellable
+    assert(book.totalOrders() == 1);
+    assert(book.cancelOrder(3));
+    assert(book.totalOrders() == 0);
+    assert(book.getAsks().empty());
+    
+    std::cout << "PASS\n";
+}
+
+void test_level_accounting() {
+    std::cout << "Test: Level Accounting... ";
+    
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    
+    // Crowded level: 100 makers of 0.01
+    std::vector<OrderPtr> makers;
+    for (int i = 0; i < 100; ++i) {
+        auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                            OrderSide::SELL, px(50000.0), qty(0.01));
+        engine.submitOrder(sell);
+        makers.push_back(sell);
+    }
+    auto book = engine.getOrderBook(BTC);
+    assert(book->getAsks()[0].second == qty(1.0));
+    
+    // Sweep 0.555: 55 full fills plus one partial
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::MARKET,
+                                       OrderSide::BUY, 0, qty(0.555));
+    engine.submitOrder(buy);
+    assert(buy->status == OrderStatus::FILLED);
+    assert(book->getAsks()[0].second == qty(0.445));
+    assert(book->checkConsistency());
+    
+    // Cancel the partially filled front order
+    assert(makers[55]->status == OrderStatus::PARTIAL_FILL);
+    assert(engine.cancelOrder(makers[55]->order_id));
+    assert(book->getAsks()[0].second == qty(0.44));
+    assert(book->checkConsistency());
+    
+    // Marketable limit that partially fills then rests
+    auto bid = std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                       OrderSide::BUY, px(50000.0), qty(0.5));
+    engine.submitOrder(bid);
+    assert(bid->status == OrderStatus::PARTIAL_FILL);
+    assert(book->getAsks().empty());
+    assert(book->getBids()[0].second == qty(0.06));
+    assert(book->checkConsistency());
+    
+    std::cout << "PASS\n";
+}
+
+void test_pooled_orders() {
+    std::cout << "Test: Pooled Orders... ";
+    
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    
+    auto sell = engine.createOrder(0, BTC, OrderType::LIMIT,
+                                   OrderSide::SELL, px(50000.0), qty(1.0));
+    OrderId sell_id = engine.submitOrder(sell);
+    auto buy = engine.createOrder(0, BTC, OrderType::LIMIT,
+                                  OrderSide::BUY, px(50000.0), qty(0.4));
+    OrderId buy_id = engine.submitOrder(buy);
+    
+    // Resting maker stays live; the filled taker retires immediately
+    assert(engine.getLiveOrderCount() == 1);
+    assert(engine.getOrder(buy_id)->status == OrderStatus::FILLED);
+    assert(engine.getOrder(sell_id).get() == sell.get());
+    
+    // Filling the maker retires it too; history still answers queries
+    auto buy2 = engine.createOrder(0, BTC, OrderType::MARKET,
+                                   OrderSide::BUY, 0, qty(0.6));
+    engine.submitOrder(buy2);
+    assert(engine.getLiveOrderCount() == 0);
+    auto record = engine.getOrder(sell_id);
+    assert(record && record->status == OrderStatus::FILLED);
+    assert(record->filled_quantity == qty(1.0));
+    
+    // Released slots are reused
+    Order* old_slot = buy.get();
+    buy.reset();
+    auto reused = engine.createOrder(0, BTC, OrderType::LIMIT,
+                                     OrderSide::BUY, px(49000.0), qty(1.0));
+    assert(reused.get() == old_slot);
+    
+    std::cout << "PASS\n";
+}
+
+void test_match_then_rest() {
+    std::cout << "Test: Match Then Rest... ";
+    
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    
+    // Every snapshot the publisher could take must be uncrossed
+    int updates = 0;
+    engine.setBookUpdateCallback([&](SymbolId symbol_id) {
+        auto [bid, ask] = engine.getBBO(symbol_id);
+        assert(!bid || !ask || *bid < *ask);
+        updates++;
+    });
+    
+    auto sell = std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                        OrderSide::SELL, px(50000.0), qty(1.0));
+    engine.submitOrder(sell);
+    assert(updates == 1);
+    OrderBook* book = engine.getOrderBook(BTC);
+    uint64_t version = book->getTopOfBook().sequence;
+    
+    // Marketable limit: fills 1.0, rests 0.5 at its own price, published
+    // as one new version (readers never see the ask gone and no bid yet)
+    auto buy = std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                       OrderSide::BUY, px(50100.0), qty(1.5));
+    engine.submitOrder(buy);
+    assert(updates == 2);
+    assert(book->getTopOfBook().sequence == version + 1);
+    assert(book->getDepth().sequence == version + 1);
+    assert(buy->status == OrderStatus::PARTIAL_FILL);
+    assert(buy->filled_quantity == qty(1.0));
+    
+    assert(book->getAsks().empty());
+    assert(book->getBids()[0] == std::make_pair(px(50100.0), qty(0.5)));
+    assert(book->checkConsistency());
+    
+    // Fully filled limit never touches its own side
+    auto sell2 = std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                         OrderSide::SELL, px(50000.0), qty(0.5));
+    engine.submitOrder(sell2);
+    assert(sell2->status == OrderStatus::FILLED);
+    assert(book->totalOrders() == 0);
+    assert(!book->getBBO().first && !book->getBBO().second);
+    
+    std::cout << "PASS\n";
+}
+
+void test_symbol_registry() {
+    std::cout << "Test: Symbol Registry... ";
+    
+    SymbolRegistry registry(4);
+    SymbolId btc = registry.intern("BTC-USDT");
+    SymbolId eth = registry.intern("ETH-USDT");
+    assert(btc == 0 && eth == 1);
+    assert(registry.intern("BTC-USDT") == btc);
+    assert(registry.find("ETH-USDT") == eth);
+    assert(registry.find("SOL-USDT") == Config::INVALID_SYMBOL);
+    assert(registry.name(eth) == "ETH-USDT");
+    assert(registry.intern("") == Config::INVALID_SYMBOL);
+    
+    // Capacity is fixed; ids already handed out stay valid
+    registry.intern("SOL-USDT");
+    registry.intern("XRP-USDT");
+    assert(registry.intern("DOGE-USDT") == Config::INVALID_SYMBOL);
+    assert(registry.size() == 4);
+    assert(registry.find("BTC-USDT") == btc);
+    
+    // Books are per id and unknown ids are rejected
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    SymbolId ETH = engine.registerSymbol("ETH-USDT");
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                               OrderSide::SELL, px(50000.0), qty(1.0)));
+    engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::LIMIT,
+                                               OrderSide::BUY, px(50000.0), qty(1.0)));
+    assert(engine.getBBO(BTC).second == px(50000.0) && !engine.getBBO(BTC).first);
+    assert(engine.getBBO(ETH).first == px(50000.0) && !engine.getBBO(ETH).second);
+    assert(engine.submitOrder(std::make_shared<Order>(0, 7, OrderType::LIMIT,
+                                                      OrderSide::BUY, px(1.0), qty(1.0))) == 0);
+    assert(engine.getOrderBook(7) == nullptr);
+    
+    std::cout << "PASS\n";
+}
+
+void test_sharded_engine() {
+    std::cout << "Test: Sharded Engine... ";
+    
+    EngineConfig config;
+    config.shard_count = 2;
+    config.pin_threads = false;
+    MatchingEngineCore engine(config);
+    
+    std::atomic<int> trade_count{0};
+    engine.setTradeCallback([&](const Trade&) { trade_count++; });
+    
+    std::vector<SymbolId> symbols;
+    for (const char* name : {"S0-USDT", "S1-USDT", "S2-USDT", "S3-USDT"}) {
+        symbols.push_back(engine.registerSymbol(name));
+    }
+    
+    // Four producers race crossing one-lot orders into every symbol
+    const int PAIRS = 250;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&] {
+            for (int i = 0; i < PAIRS; ++i) {
+                for (SymbolId sym : symbols) {
+                    engine.submitOrderAsync(engine.createOrder(0, sym, OrderType::LIMIT,
+                                                               OrderSide::SELL, px(100.0), 1));
+                    engine.submitOrderAsync(engine.createOrder(0, sym, OrderType::LIMIT,
+                                                               OrderSide::BUY, px(100.0), 1));
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    
+    // A synchronous round trip per symbol queues behind everything above
+    for (SymbolId sym : symbols) {
+        auto probe = engine.createOrder(0, sym, OrderType::LIMIT, OrderSide::BUY, px(1.0), 1);
+        OrderId probe_id = engine.submitOrder(probe);
+        assert(probe->status == OrderStatus::ACTIVE);
+        assert(engine.cancelOrder(probe_id));
+        assert(!engine.cancelOrder(probe_id));
+    }
+    
+    assert(trade_count == 4 * PAIRS * 4);
+    assert(engine.getTotalOrdersProcessed() == 4 * PAIRS * 4 * 2 + 4);
+    assert(engine.getLiveOrderCount() == 0);
+    for (SymbolId sym : symbols) {
+        OrderBook* book = engine.getOrderBook(sym);
+        assert(book->getBids().empty() && book->getAsks().empty());
+        assert(book->checkConsistency());
+    }
+    
+    std::cout << "PASS\n";
+}
+
+void test_batch_submission() {
+    std::cout << "Test: Batch Submission... ";
+    
+    for (size_t shard_count : {size_t(0), size_t(2)}) {
+        EngineConfig config;
+        config.shard_count = shard_count;
+        MatchingEngineCore engine(config);
+        SymbolId BTC = engine.registerSymbol("BTC-USDT");
+        SymbolId ETH = engine.registerSymbol("ETH-USDT");
+        
+        std::atomic<int> btc_updates{0};
+        std::atomic<int> trades{0};
+        engine.setBookUpdateCallback([&](SymbolId symbol_id) {
+            if (symbol_id == BTC) btc_updates++;
+        });
+        engine.setTradeCallback([&](const Trade&) { trades++; });
+        
+        // Interleaved symbols; the crossing buy matches the ask earlier in
+        // the same batch, and the zero-quantity order is rejected in place
+        std::vector<OrderPtr> batch = {
+            std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL, px(50000.0), qty(1.0)),
+            std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::BUY, px(3000.0), qty(2.0)),
+            std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::BUY, px(49900.0), qty(1.0)),
+            std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL, px(50000.0), 0),
+            std::make_shared<Order>(0, BTC, OrderType::IOC, OrderSide::BUY, px(50000.0), qty(0.4)),
+        };
+        std::vector<OrderId> ids = engine.submitOrders(batch);
+        assert(ids.size() == batch.size());
+        assert(ids[0] != 0 && ids[1] != 0 && ids[2] != 0 && ids[4] != 0);
+        assert(ids[3] == 0);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            assert(ids[i] == 0 || batch[i]->order_id == ids[i]);
+        }
+        
+        assert(batch[4]->status == OrderStatus::FILLED);
+        assert(batch[0]->filled_quantity == qty(0.4));
+        assert(trades == 1);
+        assert(btc_updates == 1);  // One BTC run, one update
+        
+        OrderBook* btc = engine.getOrderBook(BTC);
+        assert(btc->getAsks()[0] == std::make_pair(px(50000.0), qty(0.6)));
+        assert(btc->getBids()[0] == std::make_pair(px(49900.0), qty(1.0)));
+        
+        std::vector<bool> cancelled = engine.cancelOrders({ids[1], 999999, ids[0], ids[4]});
+        assert(cancelled == std::vector<bool>({true, false, true, false}));
+        assert(btc->getAsks().empty());
+        assert(engine.getOrderBook(ETH)->getBids().empty());
+        assert(engine.getOrder(ids[0])->status == OrderStatus::CANCELLED);
+        assert(engine.getLiveOrderCount() == 1);
+        assert(engine.getTotalOrdersProcessed() == 4);
+    }
+    
+    std::cout << "PASS\n";
+}
+
+void test_stop_trigger_book() {
+    std::cout << "Test: Stop Trigger Book... ";
+    
+    const SymbolId BTC = 0;
+    StopOrderManager stops;
+    
+    // Buy stops and sell take-profits fire on the way up, sell stops and
+    // buy take-profits on the way down
+    std::vector<std::unique_ptr<Order>> orders;
+    auto add = [&](OrderId id, OrderType type, OrderSide side, double stop) {
+        orders.push_back(std::make_unique<Order>(id, BTC, type, side, px(49000.0), qty(1.0)));
+        orders.back()->stop_price = px(stop);
+        stops.addStopOrder(*orders.back());
+        return orders.back().get();
+    };
+    Order* buy_stop_far = add(1, OrderType::STOP_LOSS, OrderSide::BUY, 50300.0);
+    Order* sell_tp = add(2, OrderType::TAKE_PROFIT, OrderSide::SELL, 50100.0);
+    Order* sell_stop = add(3, OrderType::STOP_LIMIT, OrderSide::SELL, 49900.0);
+    Order* buy_stop = add(4, OrderType::STOP_LOSS, OrderSide::BUY, 50050.0);
+    Order* buy_tp = add(5, OrderType::TAKE_PROFIT, OrderSide::BUY, 49700.0);
+    assert(stops.getStopOrderCount() == 5);
+    
+    // Nothing between the two closest thresholds
+    assert(stops.checkTriggers(BTC, px(49950.0), px(50000.0)).empty());
+    
+    // One match trading 49900..50100 crosses exactly three, in arrival order
+    auto triggered = stops.checkTriggers(BTC, px(49900.0), px(50100.0));
+    assert(triggered == std::vector<Order*>({sell_tp, sell_stop, buy_stop}));
+    assert(sell_tp->type == OrderType::MARKET && sell_stop->type == OrderType::LIMIT);
+    assert(stops.getStopOrderCount() == 2);
+    assert(stops.checkTriggers(BTC, px(49900.0), px(50100.0)).empty());
+    
+    assert(stops.cancelStopOrder(buy_tp->order_id));
+    assert(!stops.cancelStopOrder(buy_tp->order_id));
+    assert(buy_tp->status == OrderStatus::CANCELLED);
+    assert(!stops.contains(sell_tp->order_id) && stops.contains(buy_stop_far->order_id));
+    std::vector<OrderId> remaining;
+    stops.forEachStopOrder(BTC, [&](const Order& order) { remaining.push_back(order.order_id); });
+    assert(remaining == std::vector<OrderId>({buy_stop_far->order_id}));
+    assert(stops.getStopOrderCount(BTC) == 1 && stops.getStopOrderCount(7) == 0);
+    
+    // Re-arming: many stops on one level, cancelled from the middle out
+    std::vector<std::unique_ptr<Order>> rearmed;
+    for (OrderId id = 100; id < 1100; ++id) {
+        rearmed.push_back(std::make_unique<Order>(id, BTC, OrderType::STOP_LOSS,
+                                                  OrderSide::SELL, 0, qty(1.0)));
+        rearmed.back()->stop_price = px(48000.0);
+        stops.addStopOrder(*rearmed.back());
+    }
+    for (size_t i = 500; i < 1000; ++i) assert(stops.cancelStopOrder(rearmed[i]->order_id));
+    for (size_t i = 500; i-- > 0; ) assert(stops.cancelStopOrder(rearmed[i]->order_id));
+    assert(stops.getStopOrderCount() == 1);
+    assert(stops.checkTriggers(BTC, px(40000.0), px(40000.0)).empty());
+    
+    // Through the engine: a sweep from 50000 to 50200 fires the buy stop
+    // at 50150 once, with its trades following the sweep
+    MatchingEngineCore engine;
+    SymbolId ETH = engine.registerSymbol("ETH-USDT");
+    for (double price : {50000.0, 50100.0, 50200.0, 50300.0}) {
+        engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::LIMIT,
+                                                   OrderSide::SELL, px(price), qty(1.0)));
+    }
+    auto stop = std::make_shared<Order>(0, ETH, OrderType::STOP_LOSS,
+                                        OrderSide::BUY, 0, qty(1.0));
+    stop->stop_price = px(50150.0);
+    engine.submitOrder(stop);
+    auto untouched = std::make_shared<Order>(0, ETH, OrderType::STOP_LOSS,
+                                             OrderSide::SELL, 0, qty(1.0));
+    untouched->stop_price = px(49000.0);
+    engine.submitOrder(untouched);
+    assert(stop->status == OrderStatus::PENDING);
+    
+    engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::MARKET,
+                                               OrderSide::BUY, 0, qty(3.0)));
+    assert(stop->status == OrderStatus::FILLED);
+    assert(stop->average_fill_price == px(50300.0));
+    assert(untouched->status == OrderStatus::PENDING);
+    assert(engine.getOrderBook(ETH)->getAsks().empty());
+    
+    std::cout << "PASS\n";
+}
+
+void test_stop_cascade() {
+    std::cout << "Test: Stop Cascade... ";
+    
+    // Each buy stop fires on the previous stop's fill and lifts the next
+    // ask, so one market order sets off a chain of N stops
+    const int N = 250;
+    for (size_t budget : {size_t(0), size_t(100)}) {
+        EngineConfig config;
+        config.stop_cascade_budget = budget;
+        MatchingEngineCore engine(config);
+        SymbolId BTC = engine.registerSymbol("BTC-USDT");
+        
+        for (int k = 1; k <= N + 1; ++k) {
+            engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL,
+                                                       px(100.0 + k), qty(1.0)));
+        }
+        std::vector<OrderPtr> stops;
+        for (int k = 1; k <= N; ++k) {
+            auto stop = std::make_shared<Order>(0, BTC, OrderType::STOP_LOSS, OrderSide::BUY,
+                                                0, qty(1.0));
+            stop->stop_price = px(100.0 + k);
+            engine.submitOrder(stop);
+            stops.push_back(stop);
+        }
+        
+        engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::MARKET, OrderSide::BUY,
+                                                   0, qty(1.0)));
+        StopCascadeStats stats = engine.getStopCascadeStats();
+        
+        if (budget == 0) {
+            assert(stats.triggered == N && stats.cascades == 1 && stats.max_depth == N);
+            assert(stats.queued == 0 && stats.budget_exhausted == 0);
+        } else {
+            // The budget cuts the chain; the rest runs after later events
+            assert(stats.triggered == budget && stats.queued == 1);
+            assert(stats.budget_exhausted == 1);
+            assert(stops[budget]->status == OrderStatus::PENDING);
+            
+            auto probe = [&] {
+                engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT,
+                                                           OrderSide::BUY, px(50.0), qty(1.0)));
+            };
+            probe();
+            assert(engine.getStopCascadeStats().triggered == 2 * budget);
+            probe();
+            stats = engine.getStopCascadeStats();
+            assert(stats.triggered == N && stats.queued == 0 && stats.max_depth == N);
+        }
+        
+        for (const auto& stop : stops) assert(stop->status == OrderStatus::FILLED);
+        assert(engine.getOrderBook(BTC)->getAsks().empty());
+    }
+    
+    std::cout << "PASS\n";
+}
+
+void test_stop_cascade_inline() {
+    std::cout << "Test: Stop Cascade Inline Drain... ";
+    
+    // Same chain as test_stop_cascade, cut after every stop
+    const int N = 3;
+    auto setup = [&](MatchingEngineCore& engine, SymbolId BTC, std::vector<OrderPtr>& stops) {
+        for (int k = 1; k <= N + 1; ++k) {
+            engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL,
+                                                       px(100.0 + k), qty(1.0)));
+        }
+        for (int k = 1; k <= N; ++k) {
+            auto stop = std::make_shared<Order>(0, BTC, OrderType::STOP_LOSS, OrderSide::BUY,
+                                                0, qty(1.0));
+            stop->stop_price = px(100.0 + k);
+            engine.submitOrder(stop);
+            stops.push_back(stop);
+        }
+        engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::MARKET, OrderSide::BUY,
+                                                   0, qty(1.0)));
+        assert(engine.getStopCascadeStats().queued == 1);
+    };
+    EngineConfig config;
+    config.stop_cascade_budget = 1;
+    
+    {
+        // Calls on another symbol finish the cascade of a quiet one
+        MatchingEngineCore engine(config);
+        SymbolId BTC = engine.registerSymbol("BTC-USDT");
+        SymbolId ETH = engine.registerSymbol("ETH-USDT");
+        std::vector<OrderPtr> stops;
+        setup(engine, BTC, stops);
+        
+        for (int k = 0; k < N; ++k) {
+            engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::BUY,
+                                                       px(10.0), qty(1.0)));
+        }
+        StopCascadeStats stats = engine.getStopCascadeStats();
+        assert(stats.triggered == N && stats.queued == 0);
+        // Depth follows the chain across drains run from other symbols' calls
+        assert(stats.max_depth == N);
+        for (const auto& stop : stops) assert(stop->status == OrderStatus::FILLED);
+    }
+    {
+        // A triggered stop still in the queue can be cancelled
+        MatchingEngineCore engine(config);
+        SymbolId BTC = engine.registerSymbol("BTC-USDT");
+        std::vector<OrderPtr> stops;
+        setup(engine, BTC, stops);
+        assert(stops[1]->status == OrderStatus::PENDING && !stops[1]->isStopOrder());
+        
+        assert(engine.cancelOrder(stops[1]->order_id));
+        assert(stops[1]->status == OrderStatus::CANCELLED);
+        assert(!engine.cancelOrder(stops[1]->order_id));
+        assert(engine.getOrder(stops[1]->order_id)->status == OrderStatus::CANCELLED);
+        
+        StopCascadeStats stats = engine.getStopCascadeStats();
+        assert(stats.triggered == 1 && stats.queued == 0);
+        // Its fill never happened, so the next stop in the chain never fires
+        assert(stops[2]->status == OrderStatus::PENDING && stops[2]->isStopOrder());
+    }
+    
+    std::cout << "PASS\n";
+}
+
+void test_seqlock_bbo() {
+    std::cout << "Test: Seqlock BBO... ";
+    
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    assert(engine.getTopOfBook(BTC).sequence == 0);
+    
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL,
+                                               px(50000.0), qty(1.0)));
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::BUY,
+                                               px(49900.0), qty(2.0)));
+    TopOfBook top = engine.getTopOfBook(BTC);
+    assert(top.hasBid() && top.hasAsk());
+    assert(top.bid_price == px(49900.0) && top.bid_quantity == qty(2.0));
+    assert(top.ask_price == px(50000.0) && top.ask_quantity == qty(1.0));
+    
+    // Fills that leave the best level in place still republish its quantity
+    uint64_t before = top.sequence;
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::MARKET, OrderSide::BUY,
+                                               0, qty(0.25)));
+    top = engine.getTopOfBook(BTC);
+    assert(top.sequence > before && top.ask_quantity == qty(0.75));
+    
+    // Readers spin on the seqlock while a shard rewrites the top: every
+    // snapshot must be internally consistent (one order per side, size 1)
+    EngineConfig config;
+    config.shard_count = 1;
+    MatchingEngineCore sharded(config);
+    SymbolId ETH = sharded.registerSymbol("ETH-USDT");
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        uint64_t last = 0;
+        while (!done.load()) {
+            TopOfBook t = sharded.getTopOfBook(ETH);
+            assert(t.sequence >= last);
+            last = t.sequence;
+            if (t.hasBid() && t.hasAsk()) {
+                assert(t.bid_quantity == qty(1.0) && t.ask_quantity == qty(1.0));
+                assert(t.ask_price - t.bid_price == px(1.0));
+            }
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        double mid = 3000.0 + (i % 50);
+        auto bid = std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::BUY,
+                                           px(mid - 0.5), qty(1.0));
+        auto ask = std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::SELL,
+                                           px(mid + 0.5), qty(1.0));
+        std::vector<OrderPtr> quote = {bid, ask};
+        std::vector<OrderId> ids = sharded.submitOrders(quote);
+        sharded.cancelOrders(ids);
+    }
+    done = true;
+    reader.join();
+    
+    std::cout << "PASS\n";
+}
+
+void test_depth_image() {
+    std::cout << "Test: Depth Image... ";
+    
+    // Random rest / cancel / sweep traffic; after every step the published
+    // image must equal a locked walk of the book, cut to DEPTH_LEVELS
+    SymbolSpec spec;
+    spec.ladder_ticks = 64;
+    const SymbolId BTC = 0;
+    OrderBook book(BTC, spec);
+    std::vector<OrderPtr> orders;
+    std::mt19937 rng(7);
+    
+    auto check = [&] {
+        DepthImage image = book.getDepth();
+        auto bids = book.getBids(1000);
+        auto asks = book.getAsks(1000);
+        assert(image.bid_count == std::min(bids.size(), Config::DEPTH_LEVELS));
+        assert(image.ask_count == std::min(asks.size(), Config::DEPTH_LEVELS));
+        for (uint32_t i = 0; i < image.bid_count; ++i) {
+            assert(image.bids[i].price == bids[i].first && image.bids[i].quantity == bids[i].second);
+        }
+        for (uint32_t i = 0; i < image.ask_count; ++i) {
+            assert(image.asks[i].price == asks[i].first && image.asks[i].quantity == asks[i].second);
+        }
+        // Every change advances both, including those below the image
+        assert(image.sequence == book.getTopOfBook().sequence);
+    };
+    
+    for (OrderId id = 1; id <= 3000; ++id) {
+        int action = rng() % 10;
+        if (action < 6) {
+            // Bids 900..999, asks 1000..1099; some land far outside the window
+            bool buy = rng() % 2;
+            Price p = buy ? 999 - Price(rng() % 100) : 1000 + Price(rng() % 100);
+            if (rng() % 20 == 0) p = buy ? 100 + Price(rng() % 50) : 5000 + Price(rng() % 50);
+            orders.push_back(std::make_shared<Order>(id, BTC, OrderType::LIMIT,
+                                                     buy ? OrderSide::BUY : OrderSide::SELL,
+                                                     p, 1 + Quantity(rng() % 5)));
+            book.addOrder(*orders.back());
+        } else if (action < 9 && !orders.empty()) {
+            book.cancelOrder(orders[rng() % orders.size()]->order_id);
+        } else {
+            auto sweep = std::make_shared<Order>(id, BTC, OrderType::MARKET,
+                                                 rng() % 2 ? OrderSide::BUY : OrderSide::SELL,
+                                                 0, 1 + Quantity(rng() % 40));
+            book.matchOrder(*sweep);
+        }
+        check();
+    }
+    assert(book.checkConsistency());
+    
+    // Readers on another thread only ever see ordered, versioned images
+    EngineConfig config;
+    config.shard_count = 1;
+    MatchingEngineCore engine(config);
+    SymbolId ETH = engine.registerSymbol("ETH-USDT");
+    engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::BUY,
+                                               px(1.0), qty(1.0)));
+    OrderBook* eth = engine.getOrderBook(ETH);
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        uint64_t last = 0;
+        while (!done.load()) {
+            DepthImage image = eth->getDepth();
+            assert(image.sequence >= last);
+            last = image.sequence;
+            for (uint32_t i = 1; i < image.ask_count; ++i) {
+                assert(image.asks[i - 1].price < image.asks[i].price);
+            }
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::SELL,
+                                                   px(3000.0 + (i % 40)), qty(1.0)));
+        if (i % 3 == 0) {
+            engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::MARKET, OrderSide::BUY,
+                                                       0, qty(2.0)));
+        }
+    }
+    done = true;
+    reader.join();
+    
+    std::cout << "PASS\n";
+}
+
+void test_level_updates() {
+    std::cout << "Test: Level Updates... ";
+    
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    
+    // A client resyncs from a depth image mid-stream, then applies only the
+    // updates newer than it; it must end up with the book's own depth
+    std::map<Price, Quantity> bids, asks;
+    DepthImage resync;
+    bool synced = false;
+    int callbacks = 0;
+    uint64_t last_sequence = 0;
+    engine.setLevelUpdateCallback([&](SymbolId symbol_id, const std::vector<LevelUpdate>& updates) {
+        assert(symbol_id == BTC && !updates.empty());
+        callbacks++;
+        for (const auto& update : updates) {
+            // No gaps: every book version carries at least one update
+            assert(update.sequence == last_sequence || update.sequence == last_sequence + 1);
+            last_sequence = update.sequence;
+            if (!synced || update.sequence <= resync.sequence) continue;
+            auto& side = (update.side == OrderSide::BUY) ? bids : asks;
+            if (update.quantity == 0) side.erase(update.price);
+            else side[update.price] = update.quantity;
+        }
+    });
+    
+    auto limit = [&](OrderSide side, double price, double quantity) {
+        auto order = std::make_shared<Order>(0, BTC, OrderType::LIMIT, side, px(price), qty(quantity));
+        engine.submitOrder(order);
+        return order;
+    };
+    
+    for (int i = 0; i < 5; ++i) {
+        limit(OrderSide::SELL, 50000.0 + 10 * i, 1.0);
+        limit(OrderSide::BUY, 49990.0 - 10 * i, 1.0);
+    }
+    assert(callbacks == 10);
+    
+    resync = engine.getOrderBook(BTC)->getDepth();
+    synced = true;
+    for (uint32_t i = 0; i < resync.bid_count; ++i) bids[resync.bids[i].price] = resync.bids[i].quantity;
+    for (uint32_t i = 0; i < resync.ask_count; ++i) asks[resync.asks[i].price] = resync.asks[i].quantity;
+    
+    // A sweep through three levels is one run: one callback, three updates
+    int before = callbacks;
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::MARKET, OrderSide::BUY,
+                                               0, qty(2.5)));
+    assert(callbacks == before + 1);
+    auto resting = limit(OrderSide::BUY, 49985.0, 0.5);
+    assert(engine.cancelOrder(resting->order_id));
+    limit(OrderSide::SELL, 49990.0, 0.25);
+    
+    OrderBook* book = engine.getOrderBook(BTC);
+    std::map<Price, Quantity> want_bids, want_asks;
+    for (const auto& [price, quantity] : book->getBids(100)) want_bids[price] = quantity;
+    for (const auto& [price, quantity] : book->getAsks(100)) want_asks[price] = quantity;
+    assert(bids == want_bids && asks == want_asks);
+    assert(asks.begin()->second == qty(0.5) && bids.rbegin()->second == qty(0.75));
+    
+    std::cout << "PASS\n";
+}
+
+void test_fok_atomic() {
+    std::cout << "Test: FOK Atomic... ";
+    
+    const SymbolId BTC = 0;
+    OrderBook book(BTC);
+    std::vector<OrderPtr> orders;
+    for (Price p : {100, 101, 102}) {
+        orders.push_back(std::make_shared<Order>(p, BTC, OrderType::LIMIT, OrderSide::SELL, p, 10));
+        book.addOrder(*orders.back());
+    }
+    
+    // Limit 101 sees 20 lots: 25 is killed untouched, 20 fills across two levels
+    std::vector<Trade> trades;
+    Order kill(1, BTC, OrderType::FOK, OrderSide::BUY, 101, 25);
+    assert(!book.fillOrKill(kill, trades));
+    assert(trades.empty() && kill.filled_quantity == 0);
+    assert(book.getAsks()[0] == std::make_pair(Price(100), Quantity(10)));
+    
+    Order fill(2, BTC, OrderType::FOK, OrderSide::BUY, 101, 20);
+    assert(book.fillOrKill(fill, trades));
+    assert(trades.size() == 2 && fill.isFullyFilled());
+    assert(book.getAsks().size() == 1);
+    
+    // Racing FOKs on an inline engine: each either fills whole or not at
+    // all, and together they never take more than the book held
+    MatchingEngineCore engine;
+    SymbolId ETH = engine.registerSymbol("ETH-USDT");
+    for (int i = 0; i < 100; ++i) {
+        engine.submitOrder(std::make_shared<Order>(0, ETH, OrderType::LIMIT, OrderSide::SELL,
+                                                   px(3000.0 + i), qty(1.0)));
+    }
+    std::atomic<int> filled{0};
+    std::vector<std::thread> takers;
+    for (int t = 0; t < 4; ++t) {
+        takers.emplace_back([&] {
+            for (int i = 0; i < 20; ++i) {
+                auto fok = std::make_shared<Order>(0, ETH, OrderType::FOK, OrderSide::BUY,
+                                                   px(3200.0), qty(3.0));
+                engine.submitOrder(fok);
+                if (fok->status == OrderStatus::FILLED) {
+                    assert(fok->filled_quantity == qty(3.0));
+                    filled++;
+                } else {
+                    assert(fok->status == OrderStatus::CANCELLED && fok->filled_quantity == 0);
+                }
+            }
+        });
+    }
+    for (auto& taker : takers) taker.join();
+    assert(filled == 33);
+    assert(engine.getOrderBook(ETH)->getAsks(100).size() == 1);
+    
+    std::cout << "PASS\n";
+}
+
+void test_terminal_order_store() {
+    std::cout << "Test: Terminal Order Store... ";
+    
+    // Count bound: the oldest record goes first; re-retiring refreshes in place
+    TerminalOrderStore store(3);
+    for (OrderId id = 1; id <= 3; ++id) {
+        Order order(id, 0, OrderType::LIMIT, OrderSide::BUY, 100, 10);
+        order.status = OrderStatus::CANCELLED;
+        store.insert(order, id);
+    }
+    Order refilled(2, 0, OrderType::LIMIT, OrderSide::BUY, 100, 10);
+    refilled.filled_quantity = 10;
+    refilled.status = OrderStatus::FILLED;
+    store.insert(refilled, 4);
+    assert(store.size() == 3 && store.find(2, 4)->status == OrderStatus::FILLED);
+    
+    Order fourth(4, 0, OrderType::MARKET, OrderSide::SELL, 0, 5);
+    fourth.status = OrderStatus::REJECTED;
+    store.insert(fourth, 5);
+    assert(!store.find(1, 5) && store.find(2, 5) && store.find(4, 5));
+    assert(store.size() == 3 && store.evicted() == 1);
+    
+    // Index survives heavy churn (backward-shift deletes)
+    for (OrderId id = 5; id < 5000; ++id) {
+        store.insert(Order(id, 0, OrderType::LIMIT, OrderSide::BUY, 100, 1), id);
+        assert(store.find(id, id) && !store.find(id - 3, id));
+    }
+    
+    // Age bound: expired records stop answering before they are overwritten
+    TerminalOrderStore aged(100, 50);
+    aged.insert(Order(1, 0, OrderType::LIMIT, OrderSide::BUY, 100, 1), 0);
+    aged.insert(Order(2, 0, OrderType::LIMIT, OrderSide::BUY, 100, 1), 40);
+    assert(aged.find(1, 50) && !aged.find(1, 51) && aged.find(2, 60));
+    aged.expire(80);
+    assert(aged.size() == 1 && !aged.find(1, 80));
+    // A reader's clock can lag the retirement stamp; that is not an old record
+    assert(aged.find(2, 30));
+    // A stamp behind the newest record is raised to it, keeping the ring ordered
+    aged.insert(Order(3, 0, OrderType::LIMIT, OrderSide::BUY, 100, 1), 20);
+    assert(aged.find(3, 90) && !aged.find(3, 91));
+    
+    // Engine: recent terminal orders still answer getOrder, older ones are gone
+    EngineConfig config;
+    config.terminal_retention_count = 4;
+    MatchingEngineCore engine(config);
+    SymbolId ETH = engine.registerSymbol("ETH-USDT");
+    std::vector<OrderId> ids;
+    for (int i = 0; i < 6; ++i) {
+        ids.push_back(engine.submitOrder(std::make_shared<Order>(
+            0, ETH, OrderType::LIMIT, OrderSide::BUY, px(3000.0), qty(1.0))));
+        engine.cancelOrder(ids.back());
+    }
+    assert(engine.getLiveOrderCount() == 0 && engine.getTerminalOrderCount() == 4);
+    assert(!engine.getOrder(ids[0]) && !engine.getOrder(ids[1]));
+    auto recent = engine.getOrder(ids[5]);
+    assert(recent && recent->status == OrderStatus::CANCELLED && recent->price == px(3000.0));
+    
+    std::cout << "PASS\n";
+}
+
+void test_async_logger() {
+    std::cout << "Test: Async Logger... ";
+    
+    AsyncLogger::Record record{};
+    record.format = "order {} {} at {} ({})";
+    record.level = LogLevel::WARN;
+    record.arg_count = 4;
+    record.types[0] = AsyncLogger::Record::UINT;    record.args[0].u = 42;
+    record.types[1] = AsyncLogger::Record::STRING;  record.args[1].s = "STOP_LOSS";
+    record.types[2] = AsyncLogger::Record::INT;     record.args[2].i = -5;
+    record.types[3] = AsyncLogger::Record::DOUBLE;  record.args[3].d = 0.5;
+    std::string line;
+    AsyncLogger::format(record, line);
+    assert(line == "[WARN] order 42 STOP_LOSS at -5 (0.5)\n");
+    
+    // Doubles keep every digit (%g printed 50000.01 as 50000)
+    record.args[3].d = 50000.01;
+    line.clear();
+    AsyncLogger::format(record, line);
+    assert(std::stod(line.substr(line.find('(') + 1)) == 50000.01);
+    
+    // Per-thread rings: every record from every thread comes out once, and
+    // each thread's records stay in order
+    FILE* out = std::tmpfile();
+    {
+        AsyncLogger logger(out, 1 << 14);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < 1000; ++i) logger.log(LogLevel::INFO, "{} {}", t, i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        logger.flush();
+        assert(logger.dropped() == 0);
+    }
+    std::rewind(out);
+    int next[4] = {0, 0, 0, 0};
+    int t, i, lines = 0;
+    while (std::fscanf(out, "%d %d", &t, &i) == 2) {
+        assert(i == next[t]++);
+        lines++;
+    }
+    assert(lines == 4000);
+    std::fclose(out);
+    
+    // A full ring drops instead of blocking, and says so
+    out = std::tmpfile();
+    uint64_t dropped;
+    {
+        AsyncLogger logger(out, 2);
+        for (int i = 0; i < 1000; ++i) logger.log(LogLevel::INFO, "{}", i);
+        logger.flush();
+        dropped = logger.dropped();
+    }
+    std::rewind(out);
+    lines = 0;
+    while (std::fscanf(out, "%d", &i) == 1) lines++;
+    assert(lines + dropped == 1000);
+    std::fclose(out);
+    
+    // Rings of exited threads are drained, then freed
+    out = std::tmpfile();
+    {
+        AsyncLogger logger(out, 16);
+        for (int t = 0; t < 50; ++t) {
+            std::thread([&logger, t] { logger.log(LogLevel::INFO, "{}", t); }).join();
+        }
+        for (int spin = 0; logger.ringCount() > 0 && spin < 5000; ++spin) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(logger.ringCount() == 0);
+    }
+    std::rewind(out);
+    lines = 0;
+    while (std::fscanf(out, "%d", &i) == 1) lines++;
+    assert(lines == 50);
+    std::fclose(out);
+    
+    std::cout << "PASS\n";
+}
+
+void test_engine_clock() {
+    std::cout << "Test: Engine Clock... ";
+    
+    // Manual clock: one stamp per inbound event, shared by all its fills
+    EngineConfig config;
+    config.clock_source = ClockSource::MANUAL;
+    config.terminal_retention_age_ns = 1000;
+    MatchingEngineCore engine(config);
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    std::vector<Trade> trades;
+    engine.setTradeCallback([&](const Trade& trade) { trades.push_back(trade); });
+    
+    engine.clock().set(1000);
+    for (int i = 0; i < 5; ++i) {
+        engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL,
+                                                   px(50000.0 + i), qty(1.0)));
+    }
+    auto stop = std::make_shared<Order>(0, BTC, OrderType::STOP_LOSS, OrderSide::BUY, 0, qty(1.0));
+    stop->stop_price = px(50002.0);
+    engine.submitOrder(stop);
+    
+    engine.clock().advance(500);
+    auto sweep = std::make_shared<Order>(0, BTC, OrderType::MARKET, OrderSide::BUY, 0, qty(3.0));
+    engine.submitOrder(sweep);
+    assert(sweep->timestamp == 1500);
+    // Three sweep fills plus the stop it triggered, all on the sweep's stamp
+    assert(trades.size() == 4);
+    for (const auto& trade : trades) assert(trade.timestamp == 1500);
+    
+    // Terminal retention ages on the same clock
+    assert(engine.getOrder(sweep->order_id));
+    engine.clock().advance(1001);
+    assert(!engine.getOrder(sweep->order_id));
+    
+    // TSC source tracks the system clock closely, and never steps backwards
+    EngineClock tsc(ClockSource::TSC);
+    Timestamp before = tsc.now();
+    int64_t skew = static_cast<int64_t>(tsc.now() - EngineClock::systemNow());
+    assert(std::llabs(skew) < 5000000);
+    tsc.recalibrate();
+    assert(tsc.now() >= before);
+    
+    std::cout << "PASS\n";
+}
+
+void test_latency_metrics() {
+    std::cout << "Test: Latency Metrics... ";
+    
+    // Buckets are contiguous and bound every value within ~3%
+    for (uint64_t v = 0; v < (uint64_t(1) << 36); v = v * 5 / 4 + 1) {
+        size_t bucket = LatencyHistogram::bucketFor(v);
+        assert(bucket < LatencyHistogram::BUCKETS);
+        uint64_t upper = LatencyHistogram::bucketUpperBound(bucket);
+        assert(upper >= v && upper - v <= v / 32);
+        assert(bucket == 0 || LatencyHistogram::bucketUpperBound(bucket - 1) < v);
+    }
+    
+    // Stripes written from several threads merge into one distribution
+    LatencyMetrics metrics(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics] {
+            for (uint64_t ns = 1; ns <= 1000; ++ns) {
+                metrics.record(LatencyStage::MATCH, 0, static_cast<uint8_t>(OrderType::LIMIT), ns * 1000);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    auto series = metrics.snapshot();
+    assert(series.size() == 1 && series[0].histogram.count == 4000);
+    const auto& hist = series[0].histogram;
+    assert(hist.percentile(0.5) >= 500000 && hist.percentile(0.5) <= 500000 * 33 / 32);
+    assert(hist.percentile(0.99) >= 990000 && hist.percentile(0.999) <= 1000000);
+    assert(hist.max == 1000000);
+    
+    // Stripes are allocated by their first record: one writer, one stripe
+    LatencyMetrics sparse(64);
+    sparse.record(LatencyStage::MATCH, 0, LatencyMetrics::NO_ORDER_TYPE, 100);
+    sparse.record(LatencyStage::MATCH, 0, LatencyMetrics::NO_ORDER_TYPE, 200);
+    series = sparse.snapshot();
+    assert(series.size() == 1 && series[0].stripes == 1 && series[0].histogram.count == 2);
+    
+    // The engine times admission and matching per symbol and order type
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::LIMIT, OrderSide::SELL, px(50000.0), qty(1.0)));
+    engine.submitOrder(std::make_shared<Order>(0, BTC, OrderType::MARKET, OrderSide::BUY, 0, qty(1.0)));
+    std::map<std::pair<LatencyStage, uint8_t>, uint64_t> counts;
+    for (const auto& s : engine.latencyMetrics().snapshot()) {
+        assert(s.symbol_id == BTC || s.order_type == LatencyMetrics::NO_ORDER_TYPE);
+        counts[{s.stage, s.order_type}] += s.histogram.count;
+    }
+    assert((counts[{LatencyStage::VALIDATE, static_cast<uint8_t>(OrderType::LIMIT)}] == 1));
+    assert((counts[{LatencyStage::MATCH, static_cast<uint8_t>(OrderType::MARKET)}] == 1));
+    assert((counts[{LatencyStage::STOP_TRIGGER, LatencyMetrics::NO_ORDER_TYPE}] == 1));
+    
+    EngineConfig quiet;
+    quiet.latency_metrics = false;
+    MatchingEngineCore untimed(quiet);
+    untimed.submitOrder(std::make_shared<Order>(0, untimed.registerSymbol("BTC-USDT"), OrderType::LIMIT,
+                                                OrderSide::SELL, px(50000.0), qty(1.0)));
+    assert(untimed.latencyMetrics().snapshot().empty());
+    
+    std::cout << "PASS\n";
+}
+
+void test_concurrent_inline_submit() {
+    std::cout << "Test: Concurrent Inline Submit... ";
+    
+    // Inline producers racing on one book: a resting order filled by another
+    // caller is retired exactly once, so the live index matches the book
+    MatchingEngineCore engine;
+    SymbolId BTC = engine.registerSymbol("BTC-USDT");
+    std::atomic<int> makers_filled{0};
+    engine.setTradeCallback([&](const Trade& trade) {
+        if (trade.maker_filled) makers_filled++;
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&engine, BTC, t] {
+            for (int i = 0; i < 500; ++i) {
+                OrderSide side = (i + t) % 2 ? OrderSide::BUY : OrderSide::SELL;
+                engine.submitOrder(engine.createOrder(0, BTC, OrderType::LIMIT, side,
+                                                      px(100.0 + (i % 3) - 1), 1 + i % 2));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    OrderBook* btc_book = engine.getOrderBook(BTC);
+    assert(btc_book->checkConsistency());
+    assert(engine.getLiveOrderCount() == btc_book->totalOrders());
+    assert(makers_filled > 0);
+    
+    std::cout << "PASS\n";
+}
+
+void test_lock_stats() {
+    std::cout << "Test: Lock Stats... ";
+    
+    // An instrumented mutex is still a mutex
+    InstrumentedMutex<LockSite::BOOK> mutex;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                std::lock_guard<InstrumentedMutex<LockSite::BOOK>> lock(mutex);
+                counter++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert(counter == 40000);
+    auto stats = LockStats::snapshot();
+    const LockSiteStats& book = stats[static_cast<size_t>(LockSite::BOOK)];
+    if (LockStats::enabled) {
+        assert(book.acquisitions >= 40000 && book.contended <= book.acquisitions);
+    } else {
+        assert(book.acquisitions == 0 && book.wait_ns == 0);
+    }
+    assert(std::string(lockSiteName(LockSite::STOP_MANAGER)) == "stop_manager");
     
     std::cout << "PASS\n";
 }
@@ -215,6 +1392,28 @@ int main() {
     test_fok_failure();
     test_price_time_priority();
     test_no_trade_through();
+    test_exact_fractional_fills();
+    test_price_ladder_book();
+    test_cancel_within_level();
+    test_level_accounting();
+    test_pooled_orders();
+    test_match_then_rest();
+    test_symbol_registry();
+    test_sharded_engine();
+    test_batch_submission();
+    test_stop_trigger_book();
+    test_stop_cascade();
+    test_stop_cascade_inline();
+    test_seqlock_bbo();
+    test_depth_image();
+    test_level_updates();
+    test_fok_atomic();
+    test_terminal_order_store();
+    test_async_logger();
+    test_engine_clock();
+    test_latency_metrics();
+    test_concurrent_inline_submit();
+    test_lock_stats();
     
     std::cout << "\n=================================\n";
     std::cout << "All Tests Passed!\n";